@@ -0,0 +1,120 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include "accel.h"
+#include "amiga_mouse_config.h"
+#include "profile.h"
+
+//=============================================================================
+// Gain tables, one entry per 2^ACCEL_SPEED_SHIFT counts per ms, the last
+// one for all the higher speeds
+//=============================================================================
+#define ACCEL_TABLE_SIZE 16
+
+static const uint16_t aaGainTables[ACCEL_CURVES_COUNT - 1][ACCEL_TABLE_SIZE] =
+{
+    // ACCEL_CURVE_LINEAR: 1.0 + 0.1 per step
+    { 0x100, 0x11A, 0x134, 0x14E, 0x168, 0x182, 0x19C, 0x1B6,
+      0x1D0, 0x1EA, 0x204, 0x21E, 0x238, 0x252, 0x26C, 0x286 },
+    // ACCEL_CURVE_THRESHOLD: doubled above the threshold, like the
+    // acceleration of the Amiga input preferences
+    { 0x100, 0x100, 0x200, 0x200, 0x200, 0x200, 0x200, 0x200,
+      0x200, 0x200, 0x200, 0x200, 0x200, 0x200, 0x200, 0x200 },
+    // ACCEL_CURVE_POWER: 1.0 + 0.03 * step^1.5
+    { 0x100, 0x108, 0x116, 0x128, 0x13D, 0x156, 0x171, 0x18E,
+      0x1AE, 0x1CF, 0x1F3, 0x218, 0x23F, 0x268, 0x292, 0x2BE },
+};
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static uint8_t s_u8Curve = ACCEL_CURVE_OFF;
+static uint8_t s_u8RemainderX = 0; // 1/256 counts carried to the next sample
+static uint8_t s_u8RemainderY = 0;
+
+//=============================================================================
+void ACCEL_set_curve(uint8_t u8CurveP)
+{
+    s_u8Curve = u8CurveP;
+    s_u8RemainderX = 0;
+    s_u8RemainderY = 0;
+}
+
+//=============================================================================
+// Returns the delta multiplied by the gain, the fraction is added to the
+// remainder and the whole counts of the remainder go to the result
+//=============================================================================
+static int16_t ApplyGain(int16_t i16DeltaP, uint16_t u16GainP, uint8_t *pu8RemainderP)
+{
+    int32_t i32Scaled = (int32_t)i16DeltaP * u16GainP + *pu8RemainderP;
+    *pu8RemainderP = (uint8_t)i32Scaled; // the fraction is always positive, the result is rounded down
+    i32Scaled >>= 8;
+    if (i32Scaled > INT16_MAX) return INT16_MAX;
+    if (i32Scaled < -INT16_MAX) return -INT16_MAX;
+    return (int16_t)i32Scaled;
+}
+
+//=============================================================================
+void ACCEL_apply(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP, uint16_t u16ElapsedUsP)
+{
+    if (ACCEL_CURVE_OFF == s_u8Curve)
+    {
+        return;
+    }
+    PROF_BEGIN(u16ProfStart);
+    // speed in counts per 1.024ms: counts * 256 / (elapsed / 4us), with 16-bit division
+    uint16_t u16Counts = ((*pi16DeltaXP < 0) ? -*pi16DeltaXP : *pi16DeltaXP)
+        + ((*pi16DeltaYP < 0) ? -*pi16DeltaYP : *pi16DeltaYP);
+    if (u16Counts > 0xff)
+    {
+        u16Counts = 0xff; // beyond the table anyway
+    }
+    uint16_t u16Elapsed = u16ElapsedUsP >> 2;
+    if (0 == u16Elapsed)
+    {
+        u16Elapsed = 1;
+    }
+    uint16_t u16Step = ((u16Counts << 8) / u16Elapsed) >> ACCEL_SPEED_SHIFT;
+    if (u16Step >= ACCEL_TABLE_SIZE)
+    {
+        u16Step = ACCEL_TABLE_SIZE - 1;
+    }
+    uint16_t u16Gain = aaGainTables[s_u8Curve - 1][u16Step];
+    *pi16DeltaXP = ApplyGain(*pi16DeltaXP, u16Gain, &s_u8RemainderX);
+    *pi16DeltaYP = ApplyGain(*pi16DeltaYP, u16Gain, &s_u8RemainderY);
+    PROF_END(PROF_ACCEL, u16ProfStart);
+}
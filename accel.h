@@ -0,0 +1,60 @@
+#ifndef __ACCEL_H__
+#define __ACCEL_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+
+//=============================================================================
+// Pointer acceleration.
+// The gain of the selected curve (8.8 fixed point, 0x0100 = 1.0) is taken
+// from a table indexed by the pointer speed. The speed is the sum of |dx|
+// and |dy| over the time since the previous sensor read. The fraction left
+// after the gain is applied is carried to the next sample, so slow moves
+// aren't lost. ACCEL_CURVE_OFF passes the deltas 1:1.
+// Main loop only.
+//=============================================================================
+void ACCEL_set_curve(uint8_t u8CurveP);
+
+//=============================================================================
+// Applies the gain to the deltas read u16ElapsedUsP after the previous read
+//=============================================================================
+void ACCEL_apply(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP, uint16_t u16ElapsedUsP);
+
+//=============================================================================
+
+#endif // __ACCEL_H__
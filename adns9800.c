@@ -39,22 +39,105 @@
 #include <delay.h>
 #include "uart.h"
 #include "spi.h"
+#include "timer.h"
+#include "profile.h"
+
+//=============================================================================
+// SROM images selected in amiga_mouse_config.h, in order of preference.
+// The images are stored uncompressed. They are encrypted by Avago and have
+// ~7.94 bits of entropy per byte; general purpose compressors (LZ, RLE,
+// Huffman) make them bigger rather than smaller, so a decoder would only
+// add code and slow down the upload. Different images have few bytes in
+// common at the same positions (13-22 of 3070, A4 and A4a 201), so every
+// image is stored separately as well.
+// The second byte of every image is the SROM ID reported by ADNS running it.
+//=============================================================================
+#if ADNS_SROM_A6_ENABLED
 #include "adns9800_srom_A6.h"
+#endif
+#if ADNS_SROM_A5_ENABLED
+#include "adns9800_srom_A5.h"
+#endif
+#if ADNS_SROM_A4_ENABLED
+#include "adns9800_srom_A4.h"
+#endif
+#if ADNS_SROM_A4A_ENABLED
+#include "adns9800_srom_A4a.h"
+#endif
+
+static const uint8_t * const aFirmwares[] =
+{
+#if ADNS_SROM_A6_ENABLED
+    ADNS_firmware_A6,
+#endif
+#if ADNS_SROM_A5_ENABLED
+    ADNS_firmware_A5,
+#endif
+#if ADNS_SROM_A4_ENABLED
+    ADNS_firmware_A4,
+#endif
+#if ADNS_SROM_A4A_ENABLED
+    ADNS_firmware_A4a,
+#endif
+};
+
+#define FIRMWARE_COUNT (sizeof(aFirmwares) / sizeof(aFirmwares[0]))
+#define FIRMWARE_ID_OFFSET 1
 
 //=============================================================================
 #define WRITE_REQUEST 0x80
+#define OBSERVATION_SROM_RUN 0x40 // SROM is running
+#define OBSERVATION_FRAME_BITS 0x3F // bits set by the sensor every frame
+#define ADNS_FRAME_WAIT_US 1000 // two run mode frames
+
+//=============================================================================
+// SPI timing between transactions.
+// Instead of waiting the worst case time after every transaction, the end
+// time and the type of the last transaction are stored, and the next
+// transaction waits only for the part of the gap which hasn't passed yet.
+//=============================================================================
+#define ADNS_T_LOAD_US 15 // minimum time of one byte in SROM load burst
+
+#define ADNS_ACCESS_READ 0 // t_SRW, t_SRR = 20us
+#define ADNS_ACCESS_WRITE 1 // t_SWW, t_SWR = 120us, 20us of it passes before NCS goes high
+#define ADNS_ACCESS_SROM_BURST 2 // ADNS needs time to exit the SROM burst mode
+
+static const uint8_t aAccessGapUs[] = { 20, 100, 200 };
+
+static uint16_t s_u16LastAccessEnd = 0; // TIMER_us() at the end of the last transaction
+static uint8_t s_u8LastAccessType = ADNS_ACCESS_READ;
+
+//=============================================================================
+// TIMER_us() wraps every 65.5ms, so after a longer break the wait may be
+// repeated once more, which is harmless.
+//=============================================================================
+static void WaitForNextAccess(void)
+{
+    uint8_t u8GapUs = aAccessGapUs[s_u8LastAccessType];
+    while ((uint16_t)(TIMER_us() - s_u16LastAccessEnd) < u8GapUs);
+}
+
+//=============================================================================
+static void EndAccess(uint8_t u8AccessTypeP)
+{
+    ADNS_com_end();
+    s_u16LastAccessEnd = TIMER_us();
+    s_u8LastAccessType = u8AccessTypeP;
+}
 
 //=============================================================================
 uint8_t ADNS_read_reg(uint8_t u8RegAddrP)
 {
+    PROF_BEGIN(u16ProfStart);
+    WaitForNextAccess();
     ADNS_com_begin();
 
     (void)SPI_transfer(u8RegAddrP & 0x7f);
     delay_us(100);
     uint8_t u8Data = SPI_transfer(0);
     Nop();
-    ADNS_com_end();
-    delay_us(19);
+    EndAccess(ADNS_ACCESS_READ);
+    PROF_END(PROF_ADNS_READ_REG, u16ProfStart);
 
     return u8Data;
 }
@@ -62,17 +145,65 @@ uint8_t ADNS_read_reg(uint8_t u8RegAddrP)
 //=============================================================================
 void ADNS_write_reg(uint8_t u8RegAddrP, uint8_t u8DataP)
 {
+    WaitForNextAccess();
     ADNS_com_begin();
     
     (void)SPI_transfer(u8RegAddrP | WRITE_REQUEST);
     (void)SPI_transfer(u8DataP);
     delay_us(20);
-    ADNS_com_end();
-    delay_us(100);
+    EndAccess(ADNS_ACCESS_WRITE);
 }
 
 //=============================================================================
-void ADNS_upload_firmware(void)
+void ADNS_read_motion_burst(motion_burst_t *pMotionBurstP)
+{
+    WaitForNextAccess();
+    ADNS_com_begin();
+
+    (void)SPI_transfer(REG_Motion_Burst & 0x7f);
+    delay_us(100); // t_SRAD-MOTBR
+    // The registers are sent by ADNS in the fixed order
+    *((uint8_t *)&pMotionBurstP->motion) = SPI_transfer(0);
+    pMotionBurstP->u8Observation = SPI_transfer(0);
+    pMotionBurstP->i16DeltaX = (uint16_t)SPI_transfer(0);
+    pMotionBurstP->i16DeltaX |= ((uint16_t)SPI_transfer(0) << 8);
+    pMotionBurstP->i16DeltaY = (uint16_t)SPI_transfer(0);
+    pMotionBurstP->i16DeltaY |= ((uint16_t)SPI_transfer(0) << 8);
+    pMotionBurstP->u8Squal = SPI_transfer(0);
+    pMotionBurstP->u8PixelSum = SPI_transfer(0);
+    pMotionBurstP->u8MaximumPixel = SPI_transfer(0);
+    pMotionBurstP->u8MinimumPixel = SPI_transfer(0);
+    pMotionBurstP->u16Shutter = ((uint16_t)SPI_transfer(0) << 8); // Shutter_Upper first
+    pMotionBurstP->u16Shutter |= (uint16_t)SPI_transfer(0);
+    // Frame_Period registers are not needed, the burst is terminated here
+    EndAccess(ADNS_ACCESS_READ); // NCS high for t_BEXIT = 500ns exits the burst mode
+}
+
+//=============================================================================
+uint8_t ADNS_firmware_count(void)
+{
+    return FIRMWARE_COUNT;
+}
+
+//=============================================================================
+uint8_t ADNS_firmware_id(uint8_t u8FirmwareP)
+{
+    return aFirmwares[u8FirmwareP][FIRMWARE_ID_OFFSET];
+}
+
+//=============================================================================
+uint8_t ADNS_find_firmware(uint8_t u8FirmwareIdP)
+{
+    uint8_t u8Firmware = 0;
+    while ((u8Firmware < FIRMWARE_COUNT) && (ADNS_firmware_id(u8Firmware) != u8FirmwareIdP))
+    {
+        u8Firmware++;
+    }
+    return u8Firmware;
+}
+
+//=============================================================================
+void ADNS_upload_firmware(uint8_t u8FirmwareP)
 {
     // Initializing firmware transfer
     ADNS_write_reg(REG_Configuration_IV, 0x02);
@@ -81,16 +212,46 @@ void ADNS_upload_firmware(void)
     ADNS_write_reg(REG_SROM_Enable, 0x18);
 
     // Transferring the firmware to ADNS
+    WaitForNextAccess();
     ADNS_com_begin();
     (void)SPI_transfer(REG_SROM_Load_Burst | WRITE_REQUEST);
     delay_us(15);
-    for (uint16_t u16Idx = 0; u16Idx < ADNS_FIRMWARE_LENGTH; u16Idx++)
+    // The firmware is streamed straight from program memory,
+    // each byte takes t_LOAD = 15us, 16-17us with the timer resolution (~50ms in total)
+    SPI_write_flash_stream((uint16_t)aFirmwares[u8FirmwareP], ADNS_FIRMWARE_LENGTH, ADNS_T_LOAD_US);
+    delay_us(2); // 10us delay before exiting burst mode
+    // Datasheet says wait 160ms for ADNS to exit the burst mode before starting new communication. Waiting 40us more as 160ms was too short.
+    EndAccess(ADNS_ACCESS_SROM_BURST);
+}
+
+//=============================================================================
+bool ADNS_is_firmware_running(void)
+{
+    if (ADNS_SUPPORTED_PRODUCT_ID != ADNS_read_reg(REG_Product_ID))
     {
-        (void)SPI_transfer(ADNS_firmware_data[u16Idx]);
+        return false;
     }
-    delay_us(2); // 10us delay before exiting burst mode
-    ADNS_com_end();
-    delay_us(200); // Datasheet says wait 160ms for ADNS to exit the burst mode before starting new communication. Waiting 40us more as 160ms was too short.
+    if (0xff != (ADNS_read_reg(REG_Inverse_Product_ID) ^ ADNS_SUPPORTED_PRODUCT_ID))
+    {
+        return false;
+    }
+    if (ADNS_find_firmware(ADNS_read_reg(REG_SROM_ID)) >= FIRMWARE_COUNT)
+    {
+        return false;
+    }
+    // Observation bits are cleared and the sensor sets them again in the next
+    // frame, below 0.5ms in run mode. They are polled for two run mode frames
+    // at most: in rest modes frames are 10ms and longer, then the full
+    // initialization (~110ms) is done rather than waiting for a frame.
+    ADNS_write_reg(REG_Observation, 0x00);
+    uint16_t u16Start = TIMER_us();
+    uint8_t u8Observation;
+    do
+    {
+        u8Observation = ADNS_read_reg(REG_Observation);
+    } while ((0 == (u8Observation & OBSERVATION_FRAME_BITS)) &&
+             ((uint16_t)(TIMER_us() - u16Start) < ADNS_FRAME_WAIT_US));
+    return (0 != (u8Observation & OBSERVATION_SROM_RUN)) && (0 != (u8Observation & OBSERVATION_FRAME_BITS));
 }
 
 //=============================================================================
@@ -37,6 +37,7 @@
 // Includes
 //=============================================================================
 #include <stdint.h>
+#include <stdbool.h>
 #include "amiga_mouse_config.h"
 
 //=============================================================================
@@ -103,6 +104,22 @@ typedef struct
     unsigned MOT               : 1; // Motion since last report or Shutdown
 } motion_t;
 
+//=============================================================================
+// Data read by one Motion Burst transaction
+//=============================================================================
+typedef struct
+{
+    motion_t motion;
+    uint8_t u8Observation;
+    int16_t i16DeltaX;
+    int16_t i16DeltaY;
+    uint8_t u8Squal; // surface quality
+    uint8_t u8PixelSum;
+    uint8_t u8MaximumPixel;
+    uint8_t u8MinimumPixel;
+    uint16_t u16Shutter;
+} motion_burst_t;
+
 //=============================================================================
 static inline void ADNS_com_begin(void)
 {
@@ -122,7 +139,36 @@ uint8_t ADNS_read_reg(uint8_t u8RegAddrP);
 void ADNS_write_reg(uint8_t u8RegAddrP, uint8_t u8DataP);
 
 //=============================================================================
-void ADNS_upload_firmware(void);
+// Reads Motion, Observation, Delta X/Y, SQUAL, Pixel statistics and Shutter
+// registers in one transaction (NCS kept low for the whole burst)
+//=============================================================================
+void ADNS_read_motion_burst(motion_burst_t *pMotionBurstP);
+
+//=============================================================================
+// Returns number of SROM images built into the firmware
+//=============================================================================
+uint8_t ADNS_firmware_count(void);
+
+//=============================================================================
+// Returns SROM ID of the image (0 - the most preferred image)
+//=============================================================================
+uint8_t ADNS_firmware_id(uint8_t u8FirmwareP);
+
+//=============================================================================
+// Returns index of the first image with the SROM ID,
+// ADNS_firmware_count() if there is no such image
+//=============================================================================
+uint8_t ADNS_find_firmware(uint8_t u8FirmwareIdP);
+
+//=============================================================================
+void ADNS_upload_firmware(uint8_t u8FirmwareP);
+
+//=============================================================================
+// Checks if ADNS is powered up and runs one of the known firmwares
+// (Product ID, Inverse Product ID, SROM ID and SROM_RUN bit of Observation)
+// Waits up to 1ms for a frame, a sensor in a rest mode fails the check.
+//=============================================================================
+bool ADNS_is_firmware_running(void);
 
 //=============================================================================
 
@@ -2,7 +2,7 @@
 // http://avagotech.com/pages/en/navigation_interface_devices/navigation_sensors/laserstream/adns-9800/
 // This firmware is Copyright Avago, please refer to them concerning modifications.
 
-static const uint8_t ADNS_firmware_data[] =
+static const uint8_t ADNS_firmware_A4a[] =
 {
 0x03, 0xa4, 0x6e, 0x16, 0x6d, 0x89, 0x3e, 0xfe, 0x5f, 0x1c, 0xb8, 0xf2, 0x47, 0x0c, 0x7b, 
 0x74, 0x6a, 0x56, 0x0f, 0x7d, 0x76, 0x71, 0x4b, 0x0c, 0x97, 0xb6, 0xcf, 0xfd, 0x78, 0x72, 
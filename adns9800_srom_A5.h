@@ -2,7 +2,7 @@
 // http://avagotech.com/pages/en/navigation_interface_devices/navigation_sensors/laserstream/adns-9800/
 // This firmware is Copyright Avago, please refer to them concerning modifications.
 
-static const uint8_t ADNS_firmware_data[] =
+static const uint8_t ADNS_firmware_A5[] =
 {
 0x03,
 0xa5,
@@ -46,6 +46,7 @@
 #define LOW  (0)
 #define INPUT   (1)
 #define OUTPUT  (0)
+#define FOSC_HZ 16000000 // internal oscillator, see setup()
 
 //=============================================================================
 // Microcontroller Input and Output ports
@@ -55,10 +56,10 @@
 #define LMB_OUT (LATBbits.LATB0)
 #define RMB_OUT (LATBbits.LATB1)
 #define NCS (LATAbits.LATA3)
-#define MISO (PORTAbits.RA2)
+#define MISO (PORTAbits.RA2) // SPI pins are accessed directly by spi.c, they must stay on RA0..RA2
 #define MOSI (LATAbits.LATA0)
 #define SCLK (LATAbits.LATA1)
-#define UART (LATBbits.LATB2)
+#define UART (LATBbits.LATB2) // written directly by uart.c above 19200 baud, it must stay on LATB2
 #define LMB_IN_PORT_DIRECTION (TRISBbits.RB4)
 #define RMB_IN_PORT_DIRECTION (TRISBbits.RB3)
 #define LMB_OUT_PORT_DIRECTION (TRISBbits.RB0)
@@ -74,6 +75,7 @@
 //#define IF_CFG if (LOW == PORTBbits.RB5)
 //#define IF_NCFG if (HIGH == PORTBbits.RB5)
 
+// H, V, HQ, VQ are written at once by quadrature.c, they must stay on LATC4..LATC7
 #define H (LATCbits.LATC5)
 #define V (LATCbits.LATC4)
 #define HQ (LATCbits.LATC6)
@@ -83,10 +85,128 @@
 #define HQ_PORT_DIRECTION (TRISCbits.RC6)
 #define VQ_PORT_DIRECTION (TRISCbits.RC7)
 
+//=============================================================================
+// Quadrature output timing
+//=============================================================================
+// Amiga reads the mouse counters every screen refresh (20ms for PAL) and the
+// counter can't change by more than 127 in between. Instead of keeping every
+// pulse longer than 157us, pulses are sent at full speed until 127 counts
+// are sent within the frame period (see quadrature.c).
+#define QUAD_TICK_US 50 // one quadrature step per Timer2 tick, max 256
+#define QUAD_SLOW_MOTION_TICKS 80 // 4ms per step - a speed of cursor shaking
+#define QUAD_COUNTS_PER_WINDOW 127
+// Pending counts kept per axis at most (4 frames), the rest of a fast swipe
+// is dropped rather than let the backlog overflow and reverse the pointer
+#define QUAD_BACKLOG_MAX (4 * QUAD_COUNTS_PER_WINDOW)
+
+// Frame budget profiles, selected by EEPROM value or QUAD_DEFAULT_PROFILE
+#define QUAD_PROFILE_PAL 0 // 50Hz, counters read every 20ms
+#define QUAD_PROFILE_NTSC 1 // 60Hz, counters read every 16.7ms
+#define QUAD_PROFILE_FAST 2 // accelerated/RTG setups reading counters every 10ms or more often
+#define QUAD_PROFILES_COUNT 3
+#ifndef QUAD_DEFAULT_PROFILE
+#define QUAD_DEFAULT_PROFILE QUAD_PROFILE_PAL
+#endif
+
+//=============================================================================
+// Pointer acceleration
+//=============================================================================
+// Gain curves (see accel.c), selected by EEPROM value or ACCEL_DEFAULT_CURVE
+#define ACCEL_CURVE_OFF 0 // sensor counts sent 1:1
+#define ACCEL_CURVE_LINEAR 1 // gain rising with the speed from 1.0 to 2.5
+#define ACCEL_CURVE_THRESHOLD 2 // gain 2.0 from 8 counts per ms, like Amiga input preferences
+#define ACCEL_CURVE_POWER 3 // gain 1.0 + 0.03 * (speed / 4 counts per ms)^1.5, up to 2.7
+#define ACCEL_CURVES_COUNT 4
+#ifndef ACCEL_DEFAULT_CURVE
+#define ACCEL_DEFAULT_CURVE ACCEL_CURVE_OFF
+#endif
+#define ACCEL_SPEED_SHIFT 2 // gain tables step is 2^2 counts per ms
+
+//=============================================================================
+// Debug UART
+//=============================================================================
+// 9600 and 19200 are sent by Timer6 interrupt, higher rates (57600, 115200,
+// 230400) hold off all interrupts for one character time (see uart.c).
+// Bit time is rounded to instruction cycles: 0.8% error at 115200, 2.1% at 230400.
+#ifndef UART_BAUDRATE // can be set by make DEFS=-DUART_BAUDRATE=115200
+#define UART_BAUDRATE 9600
+#endif
+#define UART_TX_BUFFER_SIZE 128 // power of 2, a message longer than that is truncated
+#define UART_TASK_BUDGET_US 500 // time of the 1ms UART task spent sending above 19200 baud
+// 1 - log messages are sent as binary frames to be decoded by tools/detokenize,
+// the texts are not stored in program memory (see log.h)
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED 0
+#endif
+
+//=============================================================================
+// Profiling
+//=============================================================================
+// 1 - end times of the start-up phases are sent after the register dump (see profile.h)
+#ifndef PROF_BOOT
+#define PROF_BOOT 1
+#endif
+#define PROF_BOOT_MARKS 16 // boot phases recorded at most
+// 1 - durations of the hot path sections are measured (see profile.h), debug builds only:
+//     make DEFS=-DPROF_SECTIONS=1
+#ifndef PROF_SECTIONS
+#define PROF_SECTIONS 0
+#endif
+#define PROF_HISTOGRAM_BUCKETS 16 // log2 buckets, the last one is 2^14 cycles (4ms) and more
+
+//=============================================================================
+// Fault statistics
+//=============================================================================
+#define STATS_LOG_INTERVAL_MS 10000 // a repeated fault is logged at most that often
+#define STATS_REPORT_PERIOD_MS 60000 // the counters are sent that often, if any of them changed
+// both buttons held that long send the fault counters, the flight recorder
+// and the hot path statistics (if PROF_SECTIONS is 1) to UART
+#define DIAG_CHORD_MS 3000
+#define TRACE_RECORDS 32 // flight recorder size (power of 2), 4 bytes of RAM each
+
+//=============================================================================
+// Telemetry
+//=============================================================================
+// 1 - motion samples are sent to UART (see telemetry.h), tuning builds only:
+//     make DEFS="-DTELEMETRY=1 -DLOG_TOKENIZED=1 -DUART_BAUDRATE=230400"
+#ifndef TELEMETRY
+#define TELEMETRY 0
+#endif
+#define TELEMETRY_DECIMATION_MAX 64 // at least every 64th sample is tried
+
+//=============================================================================
+// Mouse buttons
+//=============================================================================
+// The first edge of a button is sent to Amiga at once, the following edges
+// are ignored for the lockout time, which must be longer than contact bouncing.
+// LMB (RB4) is captured by PORTB interrupt-on-change, RMB (RB3) has no
+// interrupt-on-change on PIC18F2xK22 and it's sampled every 1ms.
+#define BUTTONS_LOCKOUT_MS 10 // 1..255
+
 //=============================================================================
 // EEPROM data layout
 //=============================================================================
 #define EE_CALIB_RESOLUTION_ADDR 0x00
+#define EE_QUAD_PROFILE_ADDR 0x01 // QUAD_PROFILE_xxx, other value - QUAD_DEFAULT_PROFILE
+#define EE_SROM_ID_ADDR 0x02 // SROM ID of the image accepted by the sensor last time
+#define EE_ACCEL_CURVE_ADDR 0x03 // ACCEL_CURVE_xxx, other value - ACCEL_DEFAULT_CURVE
+
+//=============================================================================
+// ADNS-9800 SROM images
+//=============================================================================
+// Enabled images are uploaded in the order: A6, A5, A4, A4a until the sensor
+// accepts one (SROM CRC and SROM ID check). The accepted image is stored in
+// EEPROM and uploaded first on the next start. Every image takes 3070 bytes
+// of program memory. A4 and A4a report the same SROM ID (0xA4).
+// PIC18F23K22 (8kB) has room for A6 only, the fallback images are enabled
+// for the 16kB PIC18F24K22 (make SROM_FALLBACK=1).
+#ifndef ADNS_SROM_FALLBACK
+#define ADNS_SROM_FALLBACK 0
+#endif
+#define ADNS_SROM_A6_ENABLED 1
+#define ADNS_SROM_A5_ENABLED 0
+#define ADNS_SROM_A4_ENABLED ADNS_SROM_FALLBACK
+#define ADNS_SROM_A4A_ENABLED 0
 
 //=============================================================================
 //
@@ -0,0 +1,18 @@
+@echo off
+rem Boot phases of the current build in gpsim, logged to boot_profile.log.
+rem With a hex file argument (e.g. builds\amiga_laser_mouse_v2.0.hex) only
+rem the debug UART writes of that build are logged to boot_profile_hex.log.
+set PATH=C:\Program Files (x86)\gpsim\bin;%PATH%
+if "%~1"=="" (
+    make || goto error
+    "C:\Program Files (x86)\gpsim\bin\gpsim" -i --command=boot_profile.commands
+) else (
+    copy /y "%~1" boot_profile.hex > nul || goto error
+    "C:\Program Files (x86)\gpsim\bin\gpsim" -i --command=boot_profile_hex.commands
+    del boot_profile.hex
+)
+pause
+exit /b 0
+:error
+pause
+exit /b 1
@@ -0,0 +1,180 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include "buttons.h"
+#include <pic18fregs.h>
+#include "amiga_mouse_config.h"
+#include "timer.h"
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static volatile bool s_bPassthrough = false;
+static volatile bool s_bLmbPressed = false;
+static volatile bool s_bRmbPressed = false;
+static uint8_t s_u8LmbLockout = 0; // ms left until the next LMB edge is accepted
+static uint8_t s_u8RmbLockout = 0; // ms left until the next RMB edge is accepted
+static uint16_t s_u16LastTick = 0; // TIMER_us() of the last buttons sample
+static volatile uint16_t s_u16MaxLatency = 0;
+
+//=============================================================================
+// Takes LMB edge if it's not locked out. Called from interrupts only.
+//=============================================================================
+static void UpdateLmb(void)
+{
+    bool bPressed = (LOW == LMB_IN);
+    if ((0 == s_u8LmbLockout) && (bPressed != s_bLmbPressed))
+    {
+        s_bLmbPressed = bPressed;
+        if (s_bPassthrough)
+        {
+            LMB_OUT = bPressed ? LOW : HIGH;
+        }
+        s_u8LmbLockout = BUTTONS_LOCKOUT_MS;
+    }
+}
+
+//=============================================================================
+// Takes RMB edge if it's not locked out. Called from interrupts only.
+//=============================================================================
+static void UpdateRmb(void)
+{
+    bool bPressed = (LOW == RMB_IN);
+    if ((0 == s_u8RmbLockout) && (bPressed != s_bRmbPressed))
+    {
+        s_bRmbPressed = bPressed;
+        if (s_bPassthrough)
+        {
+            RMB_OUT = bPressed ? LOW : HIGH;
+        }
+        s_u8RmbLockout = BUTTONS_LOCKOUT_MS;
+    }
+}
+
+//=============================================================================
+void BUTTONS_init(void)
+{
+    s_bLmbPressed = (LOW == LMB_IN);
+    s_bRmbPressed = (LOW == RMB_IN);
+    s_u16LastTick = TIMER_us();
+
+    IOCBbits.IOCB4 = 1; // LMB_IN
+    INTCON2bits.RBIP = 0; // low priority
+    (void)PORTB; // end the mismatch condition before RBIF can be cleared
+    INTCONbits.RBIF = 0;
+    INTCONbits.RBIE = 1;
+}
+
+//=============================================================================
+void BUTTONS_set_passthrough(bool bPassthroughP)
+{
+    if (bPassthroughP == s_bPassthrough)
+    {
+        return;
+    }
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEL;
+    INTCONbits.GIEL = 0; // buttons are handled by the low priority interrupt
+    s_bPassthrough = bPassthroughP;
+    if (bPassthroughP)
+    {
+        LMB_OUT = s_bLmbPressed ? LOW : HIGH;
+        RMB_OUT = s_bRmbPressed ? LOW : HIGH;
+    }
+    else
+    {
+        LMB_OUT = HIGH; // button not pressed
+        RMB_OUT = HIGH; // button not pressed
+    }
+    INTCONbits.GIEL = u8InterruptsEnabled;
+}
+
+//=============================================================================
+bool BUTTONS_is_lmb_pressed(void)
+{
+    return s_bLmbPressed;
+}
+
+//=============================================================================
+bool BUTTONS_is_rmb_pressed(void)
+{
+    return s_bRmbPressed;
+}
+
+//=============================================================================
+uint16_t BUTTONS_max_latency_us(void)
+{
+    PIE5bits.TMR4IE = 0;
+    uint16_t u16MaxLatency = s_u16MaxLatency;
+    s_u16MaxLatency = 0;
+    PIE5bits.TMR4IE = 1;
+    return u16MaxLatency;
+}
+
+//=============================================================================
+void BUTTONS_tick(void)
+{
+    if (0 != s_u8LmbLockout)
+    {
+        // the button could be released while edges were ignored, check it again
+        if (0 == --s_u8LmbLockout)
+        {
+            UpdateLmb();
+        }
+    }
+    if (0 != s_u8RmbLockout)
+    {
+        s_u8RmbLockout--;
+    }
+    UpdateRmb();
+
+    uint16_t u16Now = TIMER_us();
+    uint16_t u16Latency = u16Now - s_u16LastTick;
+    s_u16LastTick = u16Now;
+    if (u16Latency > s_u16MaxLatency)
+    {
+        s_u16MaxLatency = u16Latency;
+    }
+}
+
+//=============================================================================
+void BUTTONS_ioc_isr(void)
+{
+    (void)PORTB; // reading PORTB ends the mismatch condition
+    INTCONbits.RBIF = 0;
+    UpdateLmb();
+}
+
+//=============================================================================
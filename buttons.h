@@ -0,0 +1,84 @@
+#ifndef __BUTTONS_H__
+#define __BUTTONS_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+//=============================================================================
+// Mouse buttons handling.
+// A button edge is copied from LMB_IN/RMB_IN to LMB_OUT/RMB_OUT by interrupt,
+// so a click reaches Amiga no matter what the main loop is doing. Edges are
+// debounced by ignoring bounces for BUTTONS_LOCKOUT_MS after the first edge.
+//=============================================================================
+
+//=============================================================================
+// Captures the current buttons state and enables interrupt-on-change for LMB.
+//=============================================================================
+void BUTTONS_init(void);
+
+//=============================================================================
+// Enables (normal mode) or disables (calibration mode) copying of the buttons
+// to Amiga. When disabled the buttons are released on Amiga side.
+//=============================================================================
+void BUTTONS_set_passthrough(bool bPassthroughP);
+
+//=============================================================================
+// Debounced buttons state, true when pressed
+//=============================================================================
+bool BUTTONS_is_lmb_pressed(void);
+bool BUTTONS_is_rmb_pressed(void);
+
+//=============================================================================
+// Returns the longest time between two buttons samples in microseconds since
+// the last call. It is the worst case delay of a RMB click sent to Amiga.
+//=============================================================================
+uint16_t BUTTONS_max_latency_us(void);
+
+//=============================================================================
+// Called from the Timer4 low priority interrupt only
+//=============================================================================
+void BUTTONS_tick(void);
+
+//=============================================================================
+// Called from the PORTB interrupt-on-change (low priority) only
+//=============================================================================
+void BUTTONS_ioc_isr(void);
+
+//=============================================================================
+
+#endif // __BUTTONS_H__
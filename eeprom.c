@@ -40,28 +40,49 @@
 bool EE_write_byte(uint8_t u8AddressP, uint8_t u8DataP)
 {
     bool bWriteStatus = true;
+    while (!EE_start_write(u8AddressP, u8DataP));
+    while (!EE_is_write_done(&bWriteStatus));
+    return bWriteStatus;
+}
+
+//=============================================================================
+bool EE_start_write(uint8_t u8AddressP, uint8_t u8DataP)
+{
+    if (EECON1bits.WR)
+    {
+        return false;
+    }
     EEDATA = u8DataP;
     EEADR = u8AddressP;
     EECON1bits.EEPGD = 0;
     EECON1bits.CFGS = 0;
+    EECON1bits.WRERR = 0;
     EECON1bits.WREN = 1;
-    INTCONbits.GIE = 0;
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0; // the unlock sequence must not be interrupted at all
     EECON2 = 0x55;
     EECON2 = 0x0AA;
     EECON1bits.WR = 1;
-    INTCONbits.GIE = 1;
-    while (EECON1bits.WR);
-    if (EECON1bits.WRERR)
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    EECON1bits.WREN = 0; // doesn't affect the write already started
+    return true;
+}
+
+//=============================================================================
+bool EE_is_write_done(bool *pbWriteStatusP)
+{
+    if (EECON1bits.WR)
     {
-        bWriteStatus = false;
+        return false;
     }
-    EECON1bits.WREN = 0;
-    return bWriteStatus;
+    *pbWriteStatusP = !EECON1bits.WRERR;
+    return true;
 }
 
 //=============================================================================
 uint8_t EE_read_byte(uint8_t u8AddressP)
 {
+    while (EECON1bits.WR); // EEPROM can't be read while it's being written
     EEADR = u8AddressP;
     EECON1bits.CFGS = 0;
     EECON1bits.EEPGD = 0;
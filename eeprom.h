@@ -41,9 +41,23 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+//=============================================================================
+// Writes a byte and waits for the end of the write (up to 4ms)
 //=============================================================================
 bool EE_write_byte(uint8_t u8AddressP, uint8_t u8DataP);
 
+//=============================================================================
+// Starts writing a byte without waiting. Returns false if the previous write
+// is still in progress.
+//=============================================================================
+bool EE_start_write(uint8_t u8AddressP, uint8_t u8DataP);
+
+//=============================================================================
+// Checks if the write started by EE_start_write() is finished. *pbWriteStatusP
+// is set to false if the write failed.
+//=============================================================================
+bool EE_is_write_done(bool *pbWriteStatusP);
+
 //=============================================================================
 uint8_t EE_read_byte(uint8_t u8AddressP);
 
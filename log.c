@@ -0,0 +1,161 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include "log.h"
+#include "uart.h"
+
+//=============================================================================
+// Module variables
+//=============================================================================
+uint8_t g_au8LogArgs[LOG_MAX_ARGS];
+
+#if LOG_TOKENIZED
+//=============================================================================
+// SLIP framing (RFC 1055)
+//=============================================================================
+#define SLIP_END 0xC0
+#define SLIP_ESC 0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+
+//=============================================================================
+// CRC-8, polynomial x^8 + x^2 + x + 1 (0x07), initial value 0
+//=============================================================================
+static uint8_t Crc8(uint8_t u8CrcP, uint8_t u8DataP)
+{
+    u8CrcP ^= u8DataP;
+    for (uint8_t u8Bit = 0; u8Bit < 8; u8Bit++)
+    {
+        u8CrcP = (u8CrcP & 0x80) ? ((u8CrcP << 1) ^ 0x07) : (u8CrcP << 1);
+    }
+    return u8CrcP;
+}
+
+//=============================================================================
+static inline uint8_t SlipLength(uint8_t u8DataP)
+{
+    return ((SLIP_END == u8DataP) || (SLIP_ESC == u8DataP)) ? 2 : 1;
+}
+
+//=============================================================================
+static void SlipPut(uint8_t u8DataP)
+{
+    if (SLIP_END == u8DataP)
+    {
+        UART_put_reserved(SLIP_ESC);
+        UART_put_reserved(SLIP_ESC_END);
+    }
+    else if (SLIP_ESC == u8DataP)
+    {
+        UART_put_reserved(SLIP_ESC);
+        UART_put_reserved(SLIP_ESC_ESC);
+    }
+    else
+    {
+        UART_put_reserved(u8DataP);
+    }
+}
+
+//=============================================================================
+// Frame: END, message index, arguments, CRC-8 of the index and arguments, END
+//=============================================================================
+void LOG_write(uint8_t u8MessageP, uint8_t u8ArgsCountP)
+{
+    uint8_t u8Crc = Crc8(0, u8MessageP);
+    uint8_t u8Length = 2 + SlipLength(u8MessageP); // END bytes and the index
+    for (uint8_t u8Arg = 0; u8Arg < u8ArgsCountP; u8Arg++)
+    {
+        u8Crc = Crc8(u8Crc, g_au8LogArgs[u8Arg]);
+        u8Length += SlipLength(g_au8LogArgs[u8Arg]);
+    }
+    u8Length += SlipLength(u8Crc);
+    if (!UART_reserve(u8Length))
+    {
+        return;
+    }
+    UART_put_reserved(SLIP_END);
+    SlipPut(u8MessageP);
+    for (uint8_t u8Arg = 0; u8Arg < u8ArgsCountP; u8Arg++)
+    {
+        SlipPut(g_au8LogArgs[u8Arg]);
+    }
+    SlipPut(u8Crc);
+    UART_put_reserved(SLIP_END);
+}
+
+#else
+//=============================================================================
+// Texts of the messages
+//=============================================================================
+static const char * const aLogTexts[LOG_MESSAGES_COUNT] =
+{
+#define LOG_MSG(id, text) text,
+#include "log_messages.def"
+#undef LOG_MSG
+};
+
+//=============================================================================
+void LOG_write(uint8_t u8MessageP, uint8_t u8ArgsCountP)
+{
+    static const char aHex[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
+    const char *szText = aLogTexts[u8MessageP];
+    uint8_t u8Length = 0;
+    while (szText[u8Length])
+    {
+        u8Length++;
+    }
+    if (!UART_reserve(u8Length + u8ArgsCountP)) // '%' is replaced by 2 characters
+    {
+        return;
+    }
+    uint8_t u8Arg = 0;
+    for (; *szText; szText++)
+    {
+        if (('%' == *szText) && (u8Arg < u8ArgsCountP))
+        {
+            UART_put_reserved(aHex[g_au8LogArgs[u8Arg] >> 4]);
+            UART_put_reserved(aHex[g_au8LogArgs[u8Arg] & 0x0f]);
+            u8Arg++;
+        }
+        else
+        {
+            UART_put_reserved(*szText);
+        }
+    }
+}
+#endif
+
+//=============================================================================
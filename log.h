@@ -0,0 +1,81 @@
+#ifndef __LOG_H__
+#define __LOG_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include "amiga_mouse_config.h"
+
+//=============================================================================
+// Diagnostic messages.
+// The messages are listed in log_messages.def. Arguments are bytes printed
+// as hex in place of '%' characters of the text, LOG0..LOG4 take 0..4 of them:
+//     LOG1(MSG_QUAD_PROFILE, u8Profile);
+// Longer messages fill g_au8LogArgs and call LOG_write() (see telemetry.c).
+// With LOG_TOKENIZED the texts are not built in. A message is sent as a SLIP
+// frame with the message index, the arguments and CRC-8, and
+// tools/detokenize rebuilds the text on the host side.
+//=============================================================================
+typedef enum
+{
+#define LOG_MSG(id, text) id,
+#include "log_messages.def"
+#undef LOG_MSG
+    LOG_MESSAGES_COUNT
+} log_message_t;
+
+#define LOG_MAX_ARGS 14
+
+// Arguments of the message being written, main loop only
+extern uint8_t g_au8LogArgs[LOG_MAX_ARGS];
+
+#define LOG0(id) LOG_write((id), 0)
+#define LOG1(id, a) do { g_au8LogArgs[0] = (a); LOG_write((id), 1); } while (0)
+#define LOG2(id, a, b) do { g_au8LogArgs[0] = (a); g_au8LogArgs[1] = (b); LOG_write((id), 2); } while (0)
+#define LOG3(id, a, b, c) do { g_au8LogArgs[0] = (a); g_au8LogArgs[1] = (b); \
+    g_au8LogArgs[2] = (c); LOG_write((id), 3); } while (0)
+#define LOG4(id, a, b, c, d) do { g_au8LogArgs[0] = (a); g_au8LogArgs[1] = (b); \
+    g_au8LogArgs[2] = (c); g_au8LogArgs[3] = (d); LOG_write((id), 4); } while (0)
+
+//=============================================================================
+// Sends the message with u8ArgsCountP arguments from g_au8LogArgs.
+// A message is either sent whole or dropped (see UART_reserve()).
+//=============================================================================
+void LOG_write(uint8_t u8MessageP, uint8_t u8ArgsCountP);
+
+//=============================================================================
+
+#endif // __LOG_H__
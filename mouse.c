@@ -35,10 +35,15 @@
 // Features implemented:
 //=============================================================================
 // - SPI communication between ADNS-9800 and PIC micro (bit banging)
-// - one-way UART communication (TX only) sending debug information via PORTB.RB2 (bit banging)
-// - handling of 2 mouse buttons
+// - one-way UART communication (TX only) sending debug information via PORTB.RB2 (bit banging by Timer6 interrupt from a buffer)
+// - log messages as text or as tokenized binary frames decoded by tools/detokenize (LOG_TOKENIZED)
+// - handling of 2 mouse buttons, sent to Amiga by interrupt with debouncing
 // - quadrature encoded protocol to send mouse position changes
-// - sending the firmware to ADNS-9800
+// - cooperative scheduler running sensor, buttons, gesture, demo and EEPROM tasks with no busy waiting
+// - quadrature pulses sent in the background by Timer2 high priority interrupt
+// - quadrature pulses sent at full speed up to 127 counts per Amiga frame (PAL, NTSC or fast profile from EEPROM)
+// - sending the firmware to ADNS-9800, trying all built-in SROM images until one is accepted
+// - firmware upload skipped after a warm reset if ADNS-9800 is still running it
 // - check for ADNS-9800 communication errors at startup
 // - demo mode - move mouse pointer along the square edge on the screen
 // - XY resolution change (calibration) by mouse buttons press if the mouse is started with both buttons pressed
@@ -68,6 +73,16 @@
 #include "spi.h"
 #include "uart.h"
 #include "eeprom.h"
+#include "quadrature.h"
+#include "timer.h"
+#include "buttons.h"
+#include "scheduler.h"
+#include "log.h"
+#include "profile.h"
+#include "stats.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "accel.h"
 #include <stdbool.h>
 
 //=============================================================================
@@ -77,6 +92,27 @@ bool g_bAdnsEnabled = false;
 uint8_t g_u8Resolution = 0;
 bool g_bCalibrationMode = false;
 uint8_t g_u8GestureMode = 0; // a mode of a ("Yes" or "No") gesture drawn by cursor
+bool g_bStoreResolution = false; // calibration value waiting to be written to EEPROM
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static bool s_bAdnsResetDone = false; // power up reset sent, the firmware upload may follow
+static uint16_t s_u16AdnsResetTime = 0; // TIMER_ms() of the power up reset
+
+// ADNS-9800 registers sent to UART after the start-up
+static const uint8_t aRegistersDump[][2] =
+{
+    {REG_Product_ID, MSG_REG_PRODUCT_ID},
+    {REG_Revision_ID, MSG_REG_REVISION_ID},
+    {REG_Motion, MSG_REG_MOTION},
+    {REG_Observation, MSG_REG_OBSERVATION},
+    {REG_SROM_ID, MSG_REG_SROM_ID},
+    {REG_Configuration_I, MSG_REG_CONFIG_I},
+    {REG_Configuration_II, MSG_REG_CONFIG_II},
+    {REG_Configuration_IV, MSG_REG_CONFIG_IV},
+    {REG_Configuration_V, MSG_REG_CONFIG_V},
+};
 
 //=============================================================================
 void delay_us(int16_t i16MicrosecondsP) // "i16MicrosecondsP" must be >= 10
@@ -92,58 +128,106 @@ void delay_us(int16_t i16MicrosecondsP) // "i16MicrosecondsP" must be >= 10
 }
 
 //=============================================================================
-static inline void SetQuadraturePhases(uint8_t u8HorPhaseP, uint8_t u8VerPhaseP)
+// Waits until u16MsP milliseconds have passed since u16StartP (TIMER_ms()).
+// The work done after u16StartP shortens the wait.
+//=============================================================================
+static void waitSince(uint16_t u16StartP, uint16_t u16MsP)
 {
-    if (0 == u8HorPhaseP)         { H = LOW;  HQ = LOW;  }
-    else if (1 == u8HorPhaseP)    { H = HIGH; HQ = LOW;  }
-    else if (2 == u8HorPhaseP)    { H = HIGH; HQ = HIGH; }
-    else if (3 == u8HorPhaseP)    { H = LOW;  HQ = HIGH; }
-
-    if (0 == u8VerPhaseP)         { V = LOW;  VQ = LOW;  }
-    else if (1 == u8VerPhaseP)    { V = HIGH; VQ = LOW;  }
-    else if (2 == u8VerPhaseP)    { V = HIGH; VQ = HIGH; }
-    else if (3 == u8VerPhaseP)    { V = LOW;  VQ = HIGH; }
-    // Quadrature pulses should be no shorter than 157us to prevent wrong counter 
-    // reading which is done every screen refresh (20ms for PAL) on Amiga
-    if (0 == g_u8GestureMode)
-        delay_us(150); // normal speed of cursor movement
-    else
-        DELAY_MS(4); // a speed of cursor shaking
+    // the first tick may come at once, so one more is waited for
+    while ((uint16_t)(TIMER_ms() - u16StartP) <= u16MsP);
 }
 
 //=============================================================================
-static inline void ADNS_set_resolution(void)
+static inline void loadResolution(void)
 {
     g_u8Resolution = EE_read_byte(EE_CALIB_RESOLUTION_ADDR);
     if ((g_u8Resolution < 0x01) || (g_u8Resolution > 0xA4))
     {
-        UART_puts("Invalid value in EEPROM 0x");
-        UART_putb(g_u8Resolution);
-        UART_puts(". saving default value 0x44\n");
+        LOG1(MSG_INVALID_EEPROM_VALUE, g_u8Resolution);
         g_u8Resolution = 0x44; // setting default resolution
-        if (!EE_write_byte(EE_CALIB_RESOLUTION_ADDR, g_u8Resolution))
+        if (!EE_write_byte(EE_CALIB_RESOLUTION_ADDR, g_u8Resolution)
+            && STATS_count(STATS_EEPROM_WRITE_FAILED))
         {
-            UART_puts("Can't store calibration value in EEPROM.\n");
+            LOG0(MSG_CALIBRATION_NOT_STORED);
         }
     }
-    UART_puts("Setting XY resolution: ");
-    UART_putb(g_u8Resolution);
-    UART_puts("\n");
+}
+
+//=============================================================================
+static inline void ADNS_set_resolution(void)
+{
+    LOG1(MSG_SETTING_RESOLUTION, g_u8Resolution);
     ADNS_write_reg(REG_Configuration_I, g_u8Resolution);
     
     uint8_t u8Stored = ADNS_read_reg(REG_Configuration_I);
-    UART_puts("XY resolution read from ADNS: 0x");
-    UART_putb(u8Stored);
-    UART_puts("\n");
+    LOG1(MSG_RESOLUTION_READ, u8Stored);
+    if (u8Stored != g_u8Resolution)
+    {
+        (void)STATS_count(STATS_SPI_READBACK_MISMATCH);
+    }
 }
 
 //=============================================================================
-static inline void ADNS_init(void)
+static inline void loadQuadratureProfile(void)
+{
+    uint8_t u8Profile = EE_read_byte(EE_QUAD_PROFILE_ADDR);
+    if (u8Profile >= QUAD_PROFILES_COUNT)
+    {
+        u8Profile = QUAD_DEFAULT_PROFILE; // the profile is not set in EEPROM
+    }
+    QUAD_set_profile(u8Profile);
+    LOG1(MSG_QUAD_PROFILE, u8Profile);
+}
+
+//=============================================================================
+static inline void loadAccelCurve(void)
+{
+    uint8_t u8Curve = EE_read_byte(EE_ACCEL_CURVE_ADDR);
+    if (u8Curve >= ACCEL_CURVES_COUNT)
+    {
+        u8Curve = ACCEL_DEFAULT_CURVE; // the curve is not set in EEPROM
+    }
+    ACCEL_set_curve(u8Curve);
+    LOG1(MSG_ACCEL_CURVE, u8Curve);
+}
+
+//=============================================================================
+static inline void ADNS_start(void)
+{
+    g_bAdnsEnabled = true;
+    // enable laser(bit 0 = 0b), in normal mode (bits 3,2,1 = 000b)
+    // reading the actual value of the register is important because the real
+    // default value is different from what is said in the datasheet, and if you
+    // change the reserved bits (like by writing 0x00...) it would not work.
+    uint8_t u8LaserDriveMode = ADNS_read_reg(REG_LASER_CTRL0);
+    ADNS_write_reg(REG_LASER_CTRL0, u8LaserDriveMode & 0xf0 );
+    ADNS_set_resolution();
+    PROF_boot_mark(MSG_BOOT_RESOLUTION_SET);
+    LOG0(MSG_ADNS_INITIALIZED);
+}
+
+//=============================================================================
+static void ADNS_power_up_reset(void)
 {
-    ADNS_com_begin();
-    ADNS_com_end(); // ensure that the serial port is reset
     ADNS_write_reg(REG_Power_Up_Reset, 0x5a);
-    DELAY_MS(50); // 50ms power up time
+    s_u16AdnsResetTime = TIMER_ms();
+    s_bAdnsResetDone = true;
+}
+
+//=============================================================================
+// Resets ADNS (unless it's just been done), uploads the SROM image and checks
+// if the sensor accepted it
+//=============================================================================
+static bool ADNS_power_up(uint8_t u8FirmwareP)
+{
+    bool bFirmwareAccepted = false;
+    if (!s_bAdnsResetDone)
+    {
+        ADNS_power_up_reset();
+    }
+    s_bAdnsResetDone = false; // the next try needs a new reset
+    waitSince(s_u16AdnsResetTime, 50); // 50ms power up time
+    PROF_boot_mark(MSG_BOOT_POWER_UP_WAIT);
     // read registers 0x02 to 0x06 (and discard the data)
     (void)ADNS_read_reg(REG_Motion);
     (void)ADNS_read_reg(REG_Delta_X_L);
@@ -151,8 +235,9 @@ static inline void ADNS_init(void)
     (void)ADNS_read_reg(REG_Delta_Y_L);
     (void)ADNS_read_reg(REG_Delta_Y_H);
     // upload the firmware
-    UART_puts("ADNS9800 Uploading firmware...\n");
-    ADNS_upload_firmware();
+    LOG1(MSG_UPLOADING_FIRMWARE, ADNS_firmware_id(u8FirmwareP));
+    ADNS_upload_firmware(u8FirmwareP);
+    PROF_boot_mark(MSG_BOOT_FIRMWARE_UPLOADED);
     
     // check firmware correctness
     uint8_t u8ProductId = ADNS_read_reg(REG_Product_ID);
@@ -163,67 +248,112 @@ static inline void ADNS_init(void)
         {
             // SROM CRC test
             ADNS_write_reg(REG_SROM_Enable, 0x15); 
-            DELAY_MS(10);
+            waitSince(TIMER_ms(), 10);
             uint8_t u8CrcLow = ADNS_read_reg(REG_Data_Out_Lower);
             uint8_t u8CrcHigh = ADNS_read_reg(REG_Data_Out_Upper);
-            if ((0xEF == u8CrcLow) && (0xBE == u8CrcHigh))
+            uint8_t u8SromId = ADNS_read_reg(REG_SROM_ID);
+            PROF_boot_mark(MSG_BOOT_CRC_CHECKED);
+            if ((0xEF != u8CrcLow) || (0xBE != u8CrcHigh))
             {
-                g_bAdnsEnabled = true;
-                // enable laser(bit 0 = 0b), in normal mode (bits 3,2,1 = 000b)
-                // reading the actual value of the register is important because the real
-                // default value is different from what is said in the datasheet, and if you
-                // change the reserved bits (like by writing 0x00...) it would not work.
-                uint8_t u8LaserDriveMode = ADNS_read_reg(REG_LASER_CTRL0);
-                ADNS_write_reg(REG_LASER_CTRL0, u8LaserDriveMode & 0xf0 );
-                ADNS_set_resolution();
-                UART_puts("Optical Chip Initialized\n");
+                LOG2(MSG_SROM_CRC_ERROR, u8CrcHigh, u8CrcLow);
+            }
+            else if (ADNS_firmware_id(u8FirmwareP) != u8SromId)
+            {
+                LOG1(MSG_INVALID_SROM_ID, u8SromId);
             }
             else
             {
-                UART_puts("SROM CRC error:0x");
-                UART_putb(u8CrcHigh);
-                UART_putb(u8CrcLow);
-                UART_puts("\n");
+                bFirmwareAccepted = true;
             }
         }
         else
         {
-            UART_puts("Product ID test failed\n");
+            LOG0(MSG_PRODUCT_ID_TEST_FAILED);
         }
     }
     else
     {
-        UART_puts("Invalid Product ID:");
-        UART_putb(u8ProductId);
-        UART_puts("\n");
+        LOG1(MSG_INVALID_PRODUCT_ID, u8ProductId);
     }
-    if (false == g_bAdnsEnabled) g_bCalibrationMode = false; // disable calibration mode if ADNS chip is not initialized
+    return bFirmwareAccepted;
 }
 
 //=============================================================================
-void ADNS_uart_print_register(uint8_t u8RegIdP, char * szRegNameP)
+// Uploads the SROM image accepted by the sensor last time (stored in EEPROM)
+// and if it fails, tries the other images in order of preference
+//=============================================================================
+static inline void ADNS_upload_accepted_firmware(void)
 {
-    uint8_t u8RegValue = ADNS_read_reg(u8RegIdP);
-    UART_puts(szRegNameP);
-    UART_puts(": 0x");
-    UART_putb(u8RegValue);
-    UART_puts("\n");
+    uint8_t u8StoredId = EE_read_byte(EE_SROM_ID_ADDR);
+    uint8_t u8Stored = ADNS_find_firmware(u8StoredId);
+    uint8_t u8Count = ADNS_firmware_count();
+    // the stored image is tried first (u8Try = 0), then all the images in order
+    for (uint8_t u8Try = 0; u8Try <= u8Count; u8Try++)
+    {
+        uint8_t u8Firmware = (0 == u8Try) ? u8Stored : (u8Try - 1);
+        if ((u8Firmware >= u8Count) || ((0 != u8Try) && (u8Firmware == u8Stored)))
+        {
+            continue; // no image stored in EEPROM, or the stored image already failed
+        }
+        if (ADNS_power_up(u8Firmware))
+        {
+            if (ADNS_firmware_id(u8Firmware) != u8StoredId)
+            {
+                if (!EE_write_byte(EE_SROM_ID_ADDR, ADNS_firmware_id(u8Firmware))
+                    && STATS_count(STATS_EEPROM_WRITE_FAILED))
+                {
+                    LOG0(MSG_SROM_ID_NOT_STORED);
+                }
+            }
+            ADNS_start();
+            return;
+        }
+    }
 }
 
 //=============================================================================
-static inline void ADNS_dispRegisters(void)
+// Starts ADNS initialization with the power up reset, so other initialization
+// can be done during the 50ms power up time. Returns true if the reset is not
+// needed, because the firmware is already running.
+//=============================================================================
+static inline bool ADNS_begin_init(bool bWarmResetP)
 {
-    ADNS_uart_print_register(REG_Product_ID, "Product ID");
-    ADNS_uart_print_register(REG_Revision_ID, "Revision ID");
-    ADNS_uart_print_register(REG_Motion, "Motion");
-    ADNS_uart_print_register(REG_Observation, "Observation");
-    ADNS_uart_print_register(REG_SROM_ID, "SROM ID");
-    ADNS_uart_print_register(REG_Configuration_I, "Config I");
-    ADNS_uart_print_register(REG_Configuration_II, "Config II");
-    ADNS_uart_print_register(REG_Configuration_IV, "Config IV");
-    ADNS_uart_print_register(REG_Configuration_V, "Config V");
+    ADNS_com_begin();
+    ADNS_com_end(); // ensure that the serial port is reset
+    // After a warm reset (brown-out, watchdog, MCLR) ADNS may have stayed
+    // powered with the firmware running, then the power up reset and the
+    // firmware upload (~100ms) are skipped.
+    if (bWarmResetP && ADNS_is_firmware_running())
+    {
+        return true;
+    }
+    ADNS_power_up_reset();
+    return false;
 }
 
+//=============================================================================
+static inline void ADNS_init(bool bFirmwareRunningP)
+{
+    if (bFirmwareRunningP)
+    {
+        LOG0(MSG_FIRMWARE_RUNNING);
+        ADNS_start();
+    }
+    else
+    {
+        ADNS_upload_accepted_firmware();
+    }
+    if (false == g_bAdnsEnabled) g_bCalibrationMode = false; // disable calibration mode if ADNS chip is not initialized
+}
+
+//=============================================================================
+void ADNS_uart_print_register(uint8_t u8RegIdP, uint8_t u8MessageP)
+{
+    uint8_t u8RegValue = ADNS_read_reg(u8RegIdP);
+    LOG1(u8MessageP, u8RegValue);
+}
+
+
 //=============================================================================
 static inline void setup(void)
 {
@@ -244,25 +374,46 @@ static inline void setup(void)
     RMB_OUT = HIGH; // button not pressed
     TRISC=0x00; //  Set all of PORTC as outputs. TX and RX must be set as outputs first
 
+    // POR bit is cleared by the power-on reset only, any other reset leaves it set
+    bool bWarmReset = (1 == RCONbits.POR);
+    RCONbits.POR = 1;
+    RCONbits.BOR = 1;
+
+    TIMER_init(); // boot phases are timed from here
+    PROF_init();
     UART_init();
-    UART_puts("Amiga Laser Mouse driver 2.0 by gps79\n");
-    
+    BUTTONS_init();
+    QUAD_init();
+    RCONbits.IPEN = 1; // two interrupt priorities: quadrature is high, the rest is low
+    INTCONbits.GIEL = 1; // enable low priority interrupts (TIMER_ms() is needed from now on)
+    INTCONbits.GIEH = 1; // enable high priority interrupts
+    // the start-up messages don't fit the buffer together, so they wait
+    // for the line (within the ADNS power up time mostly)
+    UART_set_blocking(true);
+    PROF_boot_mark(MSG_BOOT_UART_INIT);
+
+    // ADNS-9800 power up reset goes first, the rest of initialization
+    // is done during its 50ms power up time
+    SPI_init();
+    PROF_boot_mark(MSG_BOOT_SPI_INIT);
+    bool bFirmwareRunning = ADNS_begin_init(bWarmReset);
+    PROF_boot_mark(MSG_BOOT_ADNS_RESET);
+
+    LOG0(MSG_BANNER);
     // Enable demo mode if both buttons are pressed during startup
     if ((LOW == LMB_IN) && (LOW == RMB_IN))
     {
         g_bCalibrationMode = true;
-        UART_puts("Calibration ON\n");
+        LOG0(MSG_CALIBRATION_ON);
     }    
+    loadQuadratureProfile();
+    loadAccelCurve();
+    loadResolution();
+    PROF_boot_mark(MSG_BOOT_SETTINGS_LOADED);
 
-    // Set V, QV, H, HQ ports as outputs
-    H_PORT_DIRECTION = OUTPUT;
-    V_PORT_DIRECTION = OUTPUT;
-    HQ_PORT_DIRECTION = OUTPUT;
-    VQ_PORT_DIRECTION = OUTPUT;
-
-    SPI_init();
-    ADNS_init();
-    ADNS_dispRegisters();
+    ADNS_init(bFirmwareRunning);
+    UART_set_blocking(false);
+    PROF_boot_mark(MSG_BOOT_DONE);
 }
 
 //=============================================================================
@@ -273,32 +424,44 @@ static inline void setup(void)
 // - 100 points up in 1s
 // - 4s of no movement
 // and repeat the sequence again
+// Task run every 10ms.
 //=============================================================================
-static inline void playDemo(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP)
+static void TaskDemo(void)
 {
     static uint8_t u8Phase = 0;
     static uint8_t u8Step = 0;
-    if (0 == u8Phase) (*pi16DeltaXP)++; // move right
-    if (1 == u8Phase) (*pi16DeltaYP)++; // move down
-    if (2 == u8Phase) (*pi16DeltaXP)--; // move left 
-    if (3 == u8Phase) (*pi16DeltaYP)--; // move up
-    DELAY_MS(9); // value set to reach ~100 mouse count pulses/s
+    if (!DEMO_MODE_ENABLED)
+    {
+        return;
+    }
+    if (0 == u8Phase) QUAD_add_motion(1, 0); // move right
+    if (1 == u8Phase) QUAD_add_motion(0, 1); // move down
+    if (2 == u8Phase) QUAD_add_motion(-1, 0); // move left 
+    if (3 == u8Phase) QUAD_add_motion(0, -1); // move up
     u8Step++;
     if (u8Step >= 100)
     {
         u8Step = 0;
         u8Phase = (u8Phase + 1) & 0x07;
-        UART_puts("Demo phase ");
-        UART_putb(u8Phase);
-        UART_puts("\n");
+        LOG1(MSG_DEMO_PHASE, u8Phase);
     }
 }
 
 //=============================================================================
-static inline void handleMouseButtons(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP)
+// Handle XY resolution change by pressing LMB (increase) or RMB (decrease) when in Calibration Mode
+// Both buttons click exits Calibration Mode
+// Task run every 5ms.
+//=============================================================================
+static void TaskButtons(void)
 {
-    // Handle XY resolution change by pressing LMB (increase) or RMB (decrease) when in Calibration Mode
-    // Both buttons click exits Calibration Mode
+    PROF_BEGIN(u16ProfStart);
+    static uint8_t u8LastButtons = 0;
+    uint8_t u8Buttons = (BUTTONS_is_lmb_pressed() ? 0x01 : 0) | (BUTTONS_is_rmb_pressed() ? 0x02 : 0);
+    if (u8Buttons != u8LastButtons)
+    {
+        u8LastButtons = u8Buttons;
+        TRACE_add(TRACE_BUTTONS, u8Buttons & 0x01, u8Buttons >> 1);
+    }
     if (g_bCalibrationMode)
     {
         bool bApplyNewResolution = false;
@@ -308,28 +471,28 @@ static inline void handleMouseButtons(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP
         {
             if (!bWaitForButtonsRelease)
             {
-                if (LOW == LMB_IN)
+                if (BUTTONS_is_lmb_pressed())
                 {
                     bWaitForButtonsRelease = true;
                     if (g_u8Resolution < 0xA4)
                     {
                         g_u8Resolution++;
                         bApplyNewResolution = true;
-                        *pi16DeltaYP += 10;
+                        QUAD_add_motion(0, 10);
                     }
                     else
                     {
                         g_u8GestureMode = 1;
                     }
                 }
-                if (LOW == RMB_IN)
+                if (BUTTONS_is_rmb_pressed())
                 {
                     bWaitForButtonsRelease = true;
                     if (g_u8Resolution > 0x01)
                     {
                         g_u8Resolution--;
                         bApplyNewResolution = true;
-                        *pi16DeltaYP -= 10;
+                        QUAD_add_motion(0, -10);
                     }
                     else
                     {
@@ -339,166 +502,348 @@ static inline void handleMouseButtons(int16_t *pi16DeltaXP, int16_t *pi16DeltaYP
             }
             else
             {
-                if ((LOW == LMB_IN) && (LOW == RMB_IN))
+                if (BUTTONS_is_lmb_pressed() && BUTTONS_is_rmb_pressed())
                 {
-                    UART_puts("Calibration OFF\n");
+                    LOG0(MSG_CALIBRATION_OFF);
                     g_bCalibrationMode = false;
                     g_u8GestureMode = 5;
                 }
             }
         }
 
-        if ((HIGH == RMB_IN) && (HIGH == LMB_IN))
+        if (!BUTTONS_is_rmb_pressed() && !BUTTONS_is_lmb_pressed())
         {
             bEnteringCalibrationModeCompleted = true;
             bWaitForButtonsRelease = false;
         }
         if (bApplyNewResolution)
         {
-            UART_puts("New XY Res:");
-            UART_putb(g_u8Resolution);
-            UART_puts("\n");
+            LOG1(MSG_NEW_RESOLUTION, g_u8Resolution);
             ADNS_write_reg(REG_Configuration_I, g_u8Resolution);
-            if (!EE_write_byte(EE_CALIB_RESOLUTION_ADDR, g_u8Resolution))
-            {
-                UART_puts("Can't store calibration value in EEPROM.\n");
-            }
-            DELAY_MS(100); // wait 100ms as a primitive buttons debouncing
+            g_bStoreResolution = true; // written to EEPROM by TaskEeprom
 
             uint8_t u8Stored = ADNS_read_reg(REG_Configuration_I);
-            UART_puts("XY resolution read from ADNS: 0x");
-            UART_putb(u8Stored);
-            UART_puts("\n");
+            LOG1(MSG_RESOLUTION_READ, u8Stored);
+            if (u8Stored != g_u8Resolution)
+            {
+                (void)STATS_count(STATS_SPI_READBACK_MISMATCH);
+            }
         }
     }
-    else // Normal buttons handling if not in Calibration Mode
-    {
-        // Handle mouse buttons
-        if (HIGH == LMB_IN)
-            LMB_OUT = HIGH; // Left Mouse Button not pressed
-        else 
-            LMB_OUT = LOW; // Left Mouse Button pressed
-        if (HIGH == RMB_IN) 
-            RMB_OUT = HIGH; // Right Mouse Button not pressed
-        else 
-            RMB_OUT = LOW; // Right Mouse Button pressed
-    }
-    
-    // Gesture drawing:
-    // "No" - horizontal cursor shake
-    if (1 == g_u8GestureMode)
-    {
-        *pi16DeltaXP -= 20;
-        g_u8GestureMode = 2;
-    }
-    else if (2 == g_u8GestureMode)
-    {
-        *pi16DeltaXP += 40;
-        g_u8GestureMode = 3;
-    }
-    else if (3 == g_u8GestureMode)
-    {
-        *pi16DeltaXP -= 20;
-        g_u8GestureMode = 4;
-    }
-    else if (4 == g_u8GestureMode)
+    // Normal buttons handling if not in Calibration Mode is done by interrupts
+    BUTTONS_set_passthrough(!g_bCalibrationMode);
+#if 0 // Enable for debug purposes only. Worst case delay of a button click sent to Amiga.
+    uint16_t u16Latency = BUTTONS_max_latency_us();
+    LOG2(MSG_BUTTONS_LATENCY, u16Latency>>8, u16Latency&0xff);
+#endif
+    PROF_END(PROF_BUTTONS, u16ProfStart);
+}
+
+//=============================================================================
+// Gesture drawing:
+// next stroke is started when the previous one has been sent to Amiga
+// Task run every 5ms.
+//=============================================================================
+static void TaskGesture(void)
+{
+    static bool bLastCalibrationMode = false;
+    static uint8_t u8LastGestureMode = 0;
+    if ((g_bCalibrationMode != bLastCalibrationMode) || (g_u8GestureMode != u8LastGestureMode))
     {
-        g_u8GestureMode = 0;
+        bLastCalibrationMode = g_bCalibrationMode;
+        u8LastGestureMode = g_u8GestureMode;
+        TRACE_add(TRACE_MODE, g_bCalibrationMode, g_u8GestureMode);
     }
-    // "Yes" - drawing "V" character
-    else if (5 == g_u8GestureMode)
+    QUAD_set_slow_motion(0 != g_u8GestureMode);
+    if (QUAD_is_idle())
     {
-        *pi16DeltaXP += 100;
-        *pi16DeltaYP += 100;
-        g_u8GestureMode = 6;
+        // "No" - horizontal cursor shake
+        if (1 == g_u8GestureMode)
+        {
+            QUAD_add_motion(-20, 0);
+            g_u8GestureMode = 2;
+        }
+        else if (2 == g_u8GestureMode)
+        {
+            QUAD_add_motion(40, 0);
+            g_u8GestureMode = 3;
+        }
+        else if (3 == g_u8GestureMode)
+        {
+            QUAD_add_motion(-20, 0);
+            g_u8GestureMode = 4;
+        }
+        else if (4 == g_u8GestureMode)
+        {
+            g_u8GestureMode = 0;
+        }
+        // "Yes" - drawing "V" character
+        else if (5 == g_u8GestureMode)
+        {
+            QUAD_add_motion(100, 100);
+            g_u8GestureMode = 6;
+        }
+        else if (6 == g_u8GestureMode)
+        {
+            QUAD_add_motion(100, -100);
+            g_u8GestureMode = 7;
+        }
+        else if (7 == g_u8GestureMode)
+        {
+            g_u8GestureMode = 0;
+        }
     }
-    else if (6 == g_u8GestureMode)
+}
+
+//=============================================================================
+// Writes the calibration value to EEPROM without waiting for the end of the write.
+// Task run every 10ms.
+//=============================================================================
+static void TaskEeprom(void)
+{
+    static bool bWriteInProgress = false;
+    if (bWriteInProgress)
     {
-        *pi16DeltaXP += 100;
-        *pi16DeltaYP -= 100;
-        g_u8GestureMode = 7;
+        bool bWriteStatus;
+        if (!EE_is_write_done(&bWriteStatus))
+        {
+            return;
+        }
+        bWriteInProgress = false;
+        if (!bWriteStatus && STATS_count(STATS_EEPROM_WRITE_FAILED))
+        {
+            LOG0(MSG_CALIBRATION_NOT_STORED);
+        }
     }
-    else if (7 == g_u8GestureMode)
+    if (g_bStoreResolution)
     {
-        g_u8GestureMode = 0;
+        g_bStoreResolution = false;
+        bWriteInProgress = EE_start_write(EE_CALIB_RESOLUTION_ADDR, g_u8Resolution);
     }
 }
 
 //=============================================================================
-static inline void loop(void)
+// Reads mouse movement from ADNS-9800 and passes it to the quadrature output.
+// Task run every 1ms.
+//=============================================================================
+static void TaskSensor(void)
 {
-    static int16_t i16DeltaX = 0;
-    static int16_t i16DeltaY = 0;
-
+    PROF_BEGIN(u16ProfStart);
     if (g_bAdnsEnabled)
     {
         // handle mouse X and Y position
-        motion_t motion;
-        *((uint8_t *)&motion) = ADNS_read_reg(REG_Motion);
-        
-        if (motion.LP_VALID && !motion.FAULT) // check if no fault occurred
+        static uint8_t u8LastMotionFlags = 0;
+        static uint16_t u16LastReadUs = 0;
+        motion_burst_t motionBurst;
+        ADNS_read_motion_burst(&motionBurst);
+        // the sensor accumulates motion between the reads, so the speed is
+        // measured over the time since the previous read
+        uint16_t u16ReadUs = TIMER_us();
+        uint16_t u16ElapsedUs = u16ReadUs - u16LastReadUs;
+        u16LastReadUs = u16ReadUs;
+        uint8_t u8Motion = *((uint8_t *)&motionBurst.motion);
+        if ((u8Motion & 0x7f) != u8LastMotionFlags) // all but MOT
+        {
+            u8LastMotionFlags = u8Motion & 0x7f;
+            TRACE_add(TRACE_MOTION_FLAGS, u8Motion, motionBurst.u8Squal);
+        }
+
+        if (motionBurst.motion.LP_VALID && !motionBurst.motion.FAULT) // check if no fault occurred
         {
-            if (motion.MOT) // if movement occurred
+            if (motionBurst.motion.MOT) // if movement occurred
             {
-                i16DeltaX = (uint16_t)ADNS_read_reg(REG_Delta_X_L); // registers must be read in the order: REG_Delta_X_L first, then REG_Delta_X_H
-                i16DeltaX |= ((uint16_t)ADNS_read_reg(REG_Delta_X_H) << 8);
-                i16DeltaY = (uint16_t)ADNS_read_reg(REG_Delta_Y_L); // registers must be read in the order: REG_Delta_Y_L first, then REG_Delta_Y_H
-                i16DeltaY |= ((uint16_t)ADNS_read_reg(REG_Delta_Y_H) << 8);
-
-#if 0 // Enable for debug purposes only. It will slow down XY movement handling
-                UART_puts("motion=(");
-                UART_putb(i16DeltaX>>8);
-                UART_putb(i16DeltaX&0xff);
-                UART_puts(",");
-                UART_putb(i16DeltaY>>8);
-                UART_putb(i16DeltaY&0xff);
-                UART_puts(")\n");
-#endif
+                TELEMETRY_sample(&motionBurst);
+                ACCEL_apply(&motionBurst.i16DeltaX, &motionBurst.i16DeltaY, u16ElapsedUs);
+                // ADNS-9800 coordinates are DeltaX>0 when moving Left, DeltaY>0 when moving Up,
+                // Amiga coordinates are DeltaX>0 when moving Right, DeltaY>0 when moving Down,
+                // so both coordinates need to be reversed.
+                QUAD_add_motion(motionBurst.i16DeltaX, motionBurst.i16DeltaY);
+                if ((motionBurst.i16DeltaX > QUAD_COUNTS_PER_WINDOW) || (motionBurst.i16DeltaX < -QUAD_COUNTS_PER_WINDOW)
+                    || (motionBurst.i16DeltaY > QUAD_COUNTS_PER_WINDOW) || (motionBurst.i16DeltaY < -QUAD_COUNTS_PER_WINDOW))
+                {
+                    (void)STATS_count(STATS_DELTA_SATURATED); // more than Amiga can take in one frame
+                    // "the pointer jumped", keep what led to it
+                    TRACE_add(TRACE_JUMP_X, motionBurst.i16DeltaX >> 8, motionBurst.i16DeltaX & 0xff);
+                    TRACE_add(TRACE_JUMP_Y, motionBurst.i16DeltaY >> 8, motionBurst.i16DeltaY & 0xff);
+                    TRACE_add(TRACE_FAULT, STATS_DELTA_SATURATED, u8Motion);
+                    TRACE_freeze();
+                }
+                else
+                {
+                    TRACE_add(TRACE_MOTION, (uint8_t)motionBurst.i16DeltaX, (uint8_t)motionBurst.i16DeltaY);
+                }
             }
         }
         else
         {
-            UART_puts("Error:motion=");
-            UART_putb(*((uint8_t *)&motion));
-            UART_puts("\n");
+            // counted rather than logged on every poll, a flaky laser would flood the UART
+            uint8_t u8Counter = motionBurst.motion.FAULT ? STATS_LASER_FAULT : STATS_LP_INVALID;
+            TRACE_add(TRACE_FAULT, u8Counter, u8Motion);
+            TRACE_freeze();
+            if (STATS_count(u8Counter))
+            {
+                LOG1(MSG_MOTION_ERROR, u8Motion);
+            }
         }
     }
-#ifdef DEMO_MODE
-    if (DEMO_MODE_ENABLED)
-    {
-        playDemo(&i16DeltaX, &i16DeltaY);
-    }
+    PROF_END(PROF_SENSOR, u16ProfStart);
+}
+
+#if 0 // Enable for debug purposes only. CPU headroom left.
+//=============================================================================
+// Task run every 1000ms.
+//=============================================================================
+static void TaskLoad(void)
+{
+    uint32_t u32IdleUs = SCHED_idle_us();
+    LOG4(MSG_IDLE_TIME, u32IdleUs>>24, (u32IdleUs>>16)&0xff, (u32IdleUs>>8)&0xff, u32IdleUs&0xff);
+    uint16_t u16Dropped = UART_dropped_count();
+    uint16_t u16QuadLatency = QUAD_max_latency_us();
+    LOG4(MSG_LOAD_STATS, SCHED_deadline_misses(), (u16QuadLatency > 0xff) ? 0xff : u16QuadLatency,
+        u16Dropped>>8, u16Dropped&0xff);
+    uint16_t u16LostTicks = QUAD_lost_ticks();
+    LOG4(MSG_QUAD_LATENCY, u16QuadLatency>>8, u16QuadLatency&0xff, u16LostTicks>>8, u16LostTicks&0xff);
+}
 #endif
-    handleMouseButtons(&i16DeltaX, &i16DeltaY);
-    
-    // ADNS-9800 coordinates are DeltaX>0 when moving Left, DeltaY>0 when moving Up,
-    // Amiga coordinates are DeltaX>0 when moving Right, DeltaY>0 when moving Down,
-    // so both coordinates need to be reversed.
-    while (((i16DeltaX != 0) || (i16DeltaY != 0)))
-    {
-        static uint8_t u8HorPhase = 0;
-        static uint8_t u8VerPhase = 0;
-        if (i16DeltaX > 0) // move +1 step in X direction
-        {
-            i16DeltaX--;
-            u8HorPhase = (u8HorPhase + 1) & 0x03;
-        }
-        if (i16DeltaX < 0) // move -1 step in X direction
-        {
-            i16DeltaX++;
-            u8HorPhase = (u8HorPhase + 3) & 0x03;
-        }
-        if (i16DeltaY > 0) // move +1 step in Y direction
+
+//=============================================================================
+// Sends the fault counters every STATS_REPORT_PERIOD_MS if any of them has
+// changed. Both buttons held for DIAG_CHORD_MS outside of Calibration Mode
+// send them at once, followed by the flight recorder (see trace.h) and the
+// hot path statistics (see profile.h).
+// Task run every 20ms.
+//=============================================================================
+static void TaskDiagnostics(void)
+{
+    static uint8_t u8ChordTicks = 0;
+    static uint16_t u16LastReportMs = 0;
+    bool bChord = false;
+    if (!g_bCalibrationMode && BUTTONS_is_lmb_pressed() && BUTTONS_is_rmb_pressed())
+    {
+        if (u8ChordTicks < (DIAG_CHORD_MS / 20))
         {
-            i16DeltaY--;
-            u8VerPhase = (u8VerPhase + 1) & 0x03;
+            u8ChordTicks++;
+            bChord = (u8ChordTicks == (DIAG_CHORD_MS / 20));
         }
-        if (i16DeltaY < 0) // move -1 step in Y direction
+    }
+    else
+    {
+        u8ChordTicks = 0;
+    }
+    uint16_t u16NowMs = TIMER_ms();
+    if (bChord || (((uint16_t)(u16NowMs - u16LastReportMs) >= STATS_REPORT_PERIOD_MS) && STATS_changed()))
+    {
+        u16LastReportMs = u16NowMs;
+        STATS_report_start();
+        if (bChord)
         {
-            i16DeltaY++;
-            u8VerPhase = (u8VerPhase + 3) & 0x03;
+            TRACE_dump_start();
+            PROF_dump_start();
         }
-        SetQuadraturePhases(u8HorPhase, u8VerPhase);
+    }
+    if (!STATS_report() && !TRACE_dump())
+    {
+        (void)PROF_dump();
+    }
+}
+
+//=============================================================================
+// Sends ADNS-9800 registers to UART one by one after the start-up, so the
+// mouse works before the dump is finished. The boot phase times follow.
+// Task run every 20ms.
+//=============================================================================
+static void TaskRegistersDump(void)
+{
+    static uint8_t u8Register = 0;
+    if (u8Register >= sizeof(aRegistersDump) / sizeof(aRegistersDump[0]))
+    {
+        (void)PROF_boot_report(); // the boot phases follow the dump
+        return;
+    }
+    if (UART_free_space() < 32)
+    {
+        return; // wait for the start-up messages to be sent, rather than drop the line
+    }
+    ADNS_uart_print_register(aRegistersDump[u8Register][0], aRegistersDump[u8Register][1]);
+    u8Register++;
+    if (u8Register >= sizeof(aRegistersDump) / sizeof(aRegistersDump[0]))
+    {
+        PROF_boot_mark(MSG_BOOT_DUMP_DONE);
+    }
+}
+
+//=============================================================================
+// Tasks are added in the order of importance, the order breaks deadline ties
+//=============================================================================
+static inline void setupTasks(void)
+{
+    SCHED_add_task(TaskSensor, 1, 1);
+    SCHED_add_task(TaskButtons, 5, 5);
+    SCHED_add_task(TaskGesture, 5, 5);
+    SCHED_add_task(TaskEeprom, 10, 10);
+#ifdef DEMO_MODE
+    SCHED_add_task(TaskDemo, 10, 10);
+#endif
+#if UART_CYCLE_EXACT
+    SCHED_add_task(UART_task, 1, 1);
+#endif
+#if 0 // Enable for debug purposes only. CPU headroom left.
+    SCHED_add_task(TaskLoad, 1000, 1000);
+#endif
+#ifdef UART_LOOPBACK_TEST
+    UART_loopback_test_init();
+    SCHED_add_task(UART_loopback_test, 1, 1);
+#else
+    SCHED_add_task(TaskRegistersDump, 20, 20); // the test would take the dump as errors
+#endif
+    SCHED_add_task(TaskDiagnostics, 20, 20);
+}
+
+//=============================================================================
+static inline void loop(void)
+{
+    PROF_BEGIN(u16ProfStart);
+    SCHED_run();
+    PROF_END(PROF_LOOP, u16ProfStart);
+}
+
+//=============================================================================
+// High priority interrupt service routine.
+// Only quadrature pulses, so their timing doesn't depend on other interrupts.
+// Its jitter is limited by the code running with GIEH cleared.
+//=============================================================================
+void isr_high(void) __interrupt(1)
+{
+    if (PIE1bits.TMR2IE && PIR1bits.TMR2IF)
+    {
+        QUAD_isr();
+    }
+}
+
+//=============================================================================
+// Low priority interrupt service routine.
+// Buttons, debug UART and time base, may be interrupted by quadrature pulses.
+//=============================================================================
+void isr_low(void) __interrupt(2)
+{
+    if (INTCONbits.RBIE && INTCONbits.RBIF)
+    {
+        BUTTONS_ioc_isr();
+    }
+#if !UART_CYCLE_EXACT
+    if (PIE5bits.TMR6IE && PIR5bits.TMR6IF)
+    {
+        UART_isr();
+    }
+#endif
+    if (PIE1bits.TMR1IE && PIR1bits.TMR1IF)
+    {
+        TIMER_timer1_isr();
+    }
+    if (PIE5bits.TMR4IE && PIR5bits.TMR4IF)
+    {
+        TIMER_isr();
+        BUTTONS_tick();
     }
 }
 
@@ -506,6 +851,7 @@ static inline void loop(void)
 void main(void)
 {
     setup();
+    setupTasks();
     while (1)
     {
         loop();
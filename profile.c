@@ -0,0 +1,211 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include "profile.h"
+#include <pic18fregs.h>
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+
+#if PROF_BOOT
+//=============================================================================
+// Module variables
+//=============================================================================
+typedef struct
+{
+    uint8_t u8Message;
+    uint32_t u32Time; // TIMER_us32() at the end of the phase
+} prof_boot_mark_t;
+
+volatile uint8_t g_u8ProfBootPhase = 0;
+static prof_boot_mark_t s_aBootMarks[PROF_BOOT_MARKS];
+static uint8_t s_u8BootMarks = 0; // number of recorded marks
+static uint8_t s_u8BootReported = 0; // number of marks sent already
+
+//=============================================================================
+void PROF_boot_mark(uint8_t u8MessageP)
+{
+    g_u8ProfBootPhase = u8MessageP;
+    if (s_u8BootMarks < PROF_BOOT_MARKS)
+    {
+        s_aBootMarks[s_u8BootMarks].u8Message = u8MessageP;
+        s_aBootMarks[s_u8BootMarks].u32Time = TIMER_us32();
+        s_u8BootMarks++;
+    }
+}
+
+//=============================================================================
+bool PROF_boot_report(void)
+{
+    if (s_u8BootReported >= s_u8BootMarks)
+    {
+        return false;
+    }
+    if (UART_free_space() >= 32) // rather than drop the line
+    {
+        uint32_t u32Time = s_aBootMarks[s_u8BootReported].u32Time;
+        LOG3(s_aBootMarks[s_u8BootReported].u8Message, (uint8_t)(u32Time >> 16), (uint8_t)(u32Time >> 8), (uint8_t)u32Time);
+        s_u8BootReported++;
+    }
+    return true;
+}
+#endif // PROF_BOOT
+
+#if PROF_SECTIONS
+//=============================================================================
+// Module variables
+//=============================================================================
+typedef struct
+{
+    uint16_t u16Min;
+    uint16_t u16Max;
+    uint32_t u32Sum; // of the last u16Count durations
+    uint16_t u16Count;
+    uint16_t au16Histogram[PROF_HISTOGRAM_BUCKETS]; // saturated counts
+} prof_section_stats_t;
+
+static prof_section_stats_t s_aSections[PROF_SECTIONS_COUNT];
+static uint8_t s_u8DumpSection = PROF_SECTIONS_COUNT; // section being sent
+static uint8_t s_u8DumpLine = 0; // line of the section being sent
+
+//=============================================================================
+void PROF_init(void)
+{
+    for (uint8_t u8Section = 0; u8Section < PROF_SECTIONS_COUNT; u8Section++)
+    {
+        s_aSections[u8Section].u16Min = 0xffff;
+    }
+    T3CON = 0x03; // Fosc/4, prescaler 1:1, 16-bit read/write mode, timer on
+}
+
+//=============================================================================
+uint16_t PROF_cycles(void)
+{
+    uint16_t u16Cycles = TMR3L; // reading TMR3L latches TMR3H
+    u16Cycles |= ((uint16_t)TMR3H << 8);
+    return u16Cycles;
+}
+
+//=============================================================================
+void PROF_end(uint8_t u8SectionP, uint16_t u16StartP)
+{
+    uint16_t u16Cycles = PROF_cycles() - u16StartP;
+    prof_section_stats_t *pStats = &s_aSections[u8SectionP];
+    if (u16Cycles < pStats->u16Min) pStats->u16Min = u16Cycles;
+    if (u16Cycles > pStats->u16Max) pStats->u16Max = u16Cycles;
+    if (0xffff == pStats->u16Count)
+    {
+        // keep the mean, rather than stop updating it
+        pStats->u16Count >>= 1;
+        pStats->u32Sum >>= 1;
+    }
+    pStats->u16Count++;
+    pStats->u32Sum += u16Cycles;
+
+    // bucket n counts durations below 2^n cycles (and at least 2^(n-1)),
+    // the last one all from 2^(n-1) up
+    uint8_t u8Bucket = 0;
+    while ((0 != u16Cycles) && (u8Bucket < (PROF_HISTOGRAM_BUCKETS - 1)))
+    {
+        u16Cycles >>= 1;
+        u8Bucket++;
+    }
+    if (0xffff != pStats->au16Histogram[u8Bucket])
+    {
+        pStats->au16Histogram[u8Bucket]++;
+    }
+}
+
+//=============================================================================
+void PROF_dump_start(void)
+{
+    s_u8DumpSection = 0;
+    s_u8DumpLine = 0;
+}
+
+//=============================================================================
+// Lines of a section: 0 - header, 1 - min/max, 2 - mean,
+// 3.. - histogram buckets (empty ones are skipped)
+//=============================================================================
+bool PROF_dump(void)
+{
+    if (s_u8DumpSection >= PROF_SECTIONS_COUNT)
+    {
+        return false;
+    }
+    if (UART_free_space() < 32)
+    {
+        return true; // rather than drop the line
+    }
+    prof_section_stats_t *pStats = &s_aSections[s_u8DumpSection];
+    if (0 == s_u8DumpLine)
+    {
+        LOG1(MSG_PROF_SECTION, s_u8DumpSection);
+    }
+    else if (1 == s_u8DumpLine)
+    {
+        LOG4(MSG_PROF_MIN_MAX, pStats->u16Min >> 8, pStats->u16Min & 0xff, pStats->u16Max >> 8, pStats->u16Max & 0xff);
+    }
+    else if (2 == s_u8DumpLine)
+    {
+        uint16_t u16Mean = (0 != pStats->u16Count) ? (uint16_t)(pStats->u32Sum / pStats->u16Count) : 0;
+        LOG4(MSG_PROF_MEAN, u16Mean >> 8, u16Mean & 0xff, pStats->u16Count >> 8, pStats->u16Count & 0xff);
+    }
+    else
+    {
+        uint8_t u8Bucket = s_u8DumpLine - 3;
+        while ((u8Bucket < PROF_HISTOGRAM_BUCKETS) && (0 == pStats->au16Histogram[u8Bucket]))
+        {
+            u8Bucket++;
+        }
+        if (u8Bucket < PROF_HISTOGRAM_BUCKETS)
+        {
+            uint16_t u16Hits = pStats->au16Histogram[u8Bucket];
+            LOG3(MSG_PROF_BUCKET, u8Bucket, u16Hits >> 8, u16Hits & 0xff);
+        }
+        s_u8DumpLine = u8Bucket + 3;
+        if (u8Bucket >= (PROF_HISTOGRAM_BUCKETS - 1))
+        {
+            s_u8DumpSection++;
+            s_u8DumpLine = 0;
+            return true;
+        }
+    }
+    s_u8DumpLine++;
+    return true;
+}
+#endif // PROF_SECTIONS
@@ -0,0 +1,120 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+#include "amiga_mouse_config.h"
+
+//=============================================================================
+// Boot profiler.
+// PROF_boot_mark() records TIMER_us32() with a message from log_messages.def
+// at the end of each start-up phase, PROF_boot_report() sends them later on,
+// when the UART isn't busy with the start-up messages:
+//     PROF_boot_mark(MSG_BOOT_SPI_INIT);
+// The message id is also written to g_u8ProfBootPhase, so the simulator can
+// log the phases with cycle counts (see boot_profile.commands).
+//=============================================================================
+#if PROF_BOOT
+extern volatile uint8_t g_u8ProfBootPhase;
+
+void PROF_boot_mark(uint8_t u8MessageP);
+
+//=============================================================================
+// Sends the next recorded phase. Returns false when all of them are sent.
+//=============================================================================
+bool PROF_boot_report(void);
+#else
+#define PROF_boot_mark(u8MessageP)
+#define PROF_boot_report() false
+#endif
+
+//=============================================================================
+// Hot path profiler.
+// Timer3 counts instruction cycles (0.25us, wraps every 16.4ms), each section
+// keeps min/max/mean and a histogram of its durations with log2 buckets:
+//     PROF_BEGIN(u16Start);
+//     ...
+//     PROF_END(PROF_ADNS_READ_REG, u16Start);
+// Main loop only. Interrupts taken inside a section are counted in, that's
+// the real duration seen by the loop. Compiled out unless PROF_SECTIONS is 1.
+//=============================================================================
+#if PROF_SECTIONS
+typedef enum
+{
+    PROF_LOOP,          // one loop() iteration
+    PROF_ADNS_READ_REG, // ADNS_read_reg()
+    PROF_SENSOR,        // TaskSensor(): motion burst read
+    PROF_BUTTONS,       // TaskButtons()
+    PROF_UART_DRAIN,    // UART_task() (above 19200 baud only)
+    PROF_ACCEL,         // ACCEL_apply() (with a curve selected only)
+    PROF_SECTIONS_COUNT
+} prof_section_t;
+
+void PROF_init(void);
+
+//=============================================================================
+// Returns Timer3 value in instruction cycles
+//=============================================================================
+uint16_t PROF_cycles(void);
+
+//=============================================================================
+// Adds the duration of the section started at u16StartP (PROF_cycles())
+//=============================================================================
+void PROF_end(uint8_t u8SectionP, uint16_t u16StartP);
+
+//=============================================================================
+// PROF_dump_start() starts sending the statistics of all sections,
+// PROF_dump() sends the next line. It returns false when all of them are sent.
+//=============================================================================
+void PROF_dump_start(void);
+bool PROF_dump(void);
+
+#define PROF_BEGIN(u16StartP) uint16_t u16StartP = PROF_cycles()
+#define PROF_END(u8SectionP, u16StartP) PROF_end((u8SectionP), (u16StartP))
+#else
+#define PROF_init()
+#define PROF_dump_start()
+#define PROF_dump() false
+#define PROF_BEGIN(u16StartP)
+#define PROF_END(u8SectionP, u16StartP)
+#endif
+
+//=============================================================================
+
+#endif // __PROFILE_H__
@@ -0,0 +1,429 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include "quadrature.h"
+#include <pic18fregs.h>
+#include "amiga_mouse_config.h"
+#include "timer.h"
+#include "stats.h"
+#include "quadrature_phases.h"
+
+//=============================================================================
+// Frame budget governor.
+// Amiga reads the mouse counters once per frame and sees the difference as
+// a signed byte, so no more than QUAD_COUNTS_PER_WINDOW steps may be sent
+// between two readings. The steps sent are counted in 1ms slots and a new
+// step is sent only if the sum of the last slots is below the budget.
+// The window covers one slot more than the frame period, because any
+// period of time spans one partial slot on each end.
+//=============================================================================
+#define QUAD_WINDOW_SLOTS_MAX 21
+
+static const uint8_t aWindowSlots[QUAD_PROFILES_COUNT] =
+{
+    21, // QUAD_PROFILE_PAL - 20ms frame
+    18, // QUAD_PROFILE_NTSC - 16.7ms frame
+    11, // QUAD_PROFILE_FAST - counters read at least every 10ms
+};
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static volatile int16_t s_i16PendingX = 0; // counts waiting to be sent in X direction
+static volatile int16_t s_i16PendingY = 0; // counts waiting to be sent in Y direction
+static volatile uint8_t s_u8TicksPerStep = 0; // additional ticks between two steps
+static uint8_t s_u8TickCountdown = 0;
+static uint8_t s_u8HorPhase = 0;
+static uint8_t s_u8VerPhase = 0;
+static uint8_t s_au8SlotCounts[QUAD_WINDOW_SLOTS_MAX]; // steps sent in each 1ms slot
+static uint8_t s_u8WindowSlots = QUAD_WINDOW_SLOTS_MAX; // number of slots in the window
+static uint8_t s_u8Slot = 0; // index of the current slot
+static uint8_t s_u8SlotTime = 0; // TIMER_ms8() of the current slot
+static uint8_t s_u8WindowCounts = 0; // steps sent in the whole window
+static volatile bool s_bNewLine = false; // pending counts changed, the line must be recalculated
+static bool s_bXIsMajor = true; // X axis has more counts to send than Y
+static uint16_t s_u16LineMajor = 0; // counts to send on the major axis when the line started
+static uint16_t s_u16LineMinor = 0; // counts to send on the minor axis when the line started
+static int16_t s_i16LineError = 0;
+static volatile uint16_t s_u16MaxLatency = 0; // the longest delay of the interrupt in microseconds
+static volatile uint16_t s_u16LostTicks = 0; // Timer2 period matches not served
+static uint16_t s_u16LastMatchUs = 0; // Timer1 time of the period match served last
+static volatile bool s_bLatencyResync = true; // the interrupt has been off, s_u16LastMatchUs is stale
+
+//=============================================================================
+// Sets all 4 quadrature lines with one write to LATC, so X and Y change
+// at the same time.
+//=============================================================================
+static inline void SetQuadraturePhases(uint8_t u8HorPhaseP, uint8_t u8VerPhaseP)
+{
+    LATC = (LATC & ~QUAD_PORT_MASK) | aPhaseTable[(u8HorPhaseP << 2) | u8VerPhaseP];
+}
+
+//=============================================================================
+static inline void StepX(void)
+{
+    if (s_i16PendingX > 0) // move +1 step in X direction
+    {
+        s_i16PendingX--;
+        s_u8HorPhase = (s_u8HorPhase + 1) & 0x03;
+    }
+    else if (s_i16PendingX < 0) // move -1 step in X direction
+    {
+        s_i16PendingX++;
+        s_u8HorPhase = (s_u8HorPhase + 3) & 0x03;
+    }
+}
+
+//=============================================================================
+static inline void StepY(void)
+{
+    if (s_i16PendingY > 0) // move +1 step in Y direction
+    {
+        s_i16PendingY--;
+        s_u8VerPhase = (s_u8VerPhase + 1) & 0x03;
+    }
+    else if (s_i16PendingY < 0) // move -1 step in Y direction
+    {
+        s_i16PendingY++;
+        s_u8VerPhase = (s_u8VerPhase + 3) & 0x03;
+    }
+}
+
+//=============================================================================
+// Starts a new line (Bresenham algorithm) from the current position to the
+// position after all pending counts are sent. The axis with more counts
+// (major) steps on every tick, the minor axis steps evenly in between, so
+// a diagonal movement is sent as a straight line instead of an "L" shape.
+//=============================================================================
+static inline void StartLine(void)
+{
+    uint16_t u16AbsX = (s_i16PendingX < 0) ? -s_i16PendingX : s_i16PendingX;
+    uint16_t u16AbsY = (s_i16PendingY < 0) ? -s_i16PendingY : s_i16PendingY;
+    s_bXIsMajor = (u16AbsX >= u16AbsY);
+    if (s_bXIsMajor)
+    {
+        s_u16LineMajor = u16AbsX;
+        s_u16LineMinor = u16AbsY;
+    }
+    else
+    {
+        s_u16LineMajor = u16AbsY;
+        s_u16LineMinor = u16AbsX;
+    }
+    s_i16LineError = s_u16LineMajor >> 1;
+    s_bNewLine = false;
+}
+
+//=============================================================================
+// Sends one step of the line. Every axis changes its phase at most once per
+// tick, so pulses on each axis are never shorter than QUAD_TICK_US.
+//=============================================================================
+static inline void StepLine(void)
+{
+    bool bStepMinor = false;
+    s_i16LineError -= s_u16LineMinor;
+    if (s_i16LineError < 0)
+    {
+        s_i16LineError += s_u16LineMajor;
+        bStepMinor = true;
+    }
+    if (s_bXIsMajor)
+    {
+        StepX();
+        if (bStepMinor) StepY();
+    }
+    else
+    {
+        StepY();
+        if (bStepMinor) StepX();
+    }
+}
+
+//=============================================================================
+static void ClearWindow(void)
+{
+    for (uint8_t u8Idx = 0; u8Idx < QUAD_WINDOW_SLOTS_MAX; u8Idx++)
+    {
+        s_au8SlotCounts[u8Idx] = 0;
+    }
+    s_u8WindowCounts = 0;
+    s_u8Slot = 0;
+}
+
+//=============================================================================
+// Moves the window forward to the current millisecond.
+// TIMER_ms8() wraps every 256ms. After a longer break in the movement old
+// counts may be taken into account once more, which can only slow down
+// the next movement a little, never speed it up over the budget.
+//=============================================================================
+static inline void AdvanceWindow(void)
+{
+    uint8_t u8Now = TIMER_ms8();
+    uint8_t u8Elapsed = u8Now - s_u8SlotTime;
+    if (0 == u8Elapsed)
+    {
+        return;
+    }
+    s_u8SlotTime = u8Now;
+    if (u8Elapsed >= s_u8WindowSlots)
+    {
+        ClearWindow();
+        return;
+    }
+    while (0 != u8Elapsed)
+    {
+        u8Elapsed--;
+        s_u8Slot++;
+        if (s_u8Slot >= s_u8WindowSlots)
+        {
+            s_u8Slot = 0;
+        }
+        s_u8WindowCounts -= s_au8SlotCounts[s_u8Slot];
+        s_au8SlotCounts[s_u8Slot] = 0;
+    }
+}
+
+//=============================================================================
+void QUAD_init(void)
+{
+    // Set V, QV, H, HQ ports as outputs
+    H_PORT_DIRECTION = OUTPUT;
+    V_PORT_DIRECTION = OUTPUT;
+    HQ_PORT_DIRECTION = OUTPUT;
+    VQ_PORT_DIRECTION = OUTPUT;
+    SetQuadraturePhases(s_u8HorPhase, s_u8VerPhase);
+
+    // Timer2 clock = Fosc/4 = 4MHz, prescaler 1:4 -> 1 timer count = 1us
+    T2CON = 0x01; // postscaler 1:1, prescaler 1:4, timer off
+    PR2 = QUAD_TICK_US - 1;
+    ClearWindow();
+    TMR2 = 0;
+    PIR1bits.TMR2IF = 0;
+    PIE1bits.TMR2IE = 0; // the interrupt is enabled when there are counts to send
+    IPR1bits.TMR2IP = 1; // high priority - pulses timing must not depend on other interrupts
+    T2CONbits.TMR2ON = 1;
+}
+
+//=============================================================================
+// Returns the pending counts plus the delta, limited to QUAD_BACKLOG_MAX.
+// The counts dropped are added to *pu16ClippedP.
+//=============================================================================
+static int16_t AddClamped(int16_t i16PendingP, int16_t i16DeltaP, uint16_t *pu16ClippedP)
+{
+    uint16_t u16Clipped = 0;
+    // the delta is limited first, so the sum can't overflow
+    if (i16DeltaP > QUAD_BACKLOG_MAX)
+    {
+        u16Clipped = (uint16_t)(i16DeltaP - QUAD_BACKLOG_MAX);
+        i16DeltaP = QUAD_BACKLOG_MAX;
+    }
+    else if (i16DeltaP < -QUAD_BACKLOG_MAX)
+    {
+        u16Clipped = (uint16_t)(-QUAD_BACKLOG_MAX - i16DeltaP);
+        i16DeltaP = -QUAD_BACKLOG_MAX;
+    }
+    int16_t i16Sum = i16PendingP + i16DeltaP;
+    if (i16Sum > QUAD_BACKLOG_MAX)
+    {
+        u16Clipped += (uint16_t)(i16Sum - QUAD_BACKLOG_MAX);
+        i16Sum = QUAD_BACKLOG_MAX;
+    }
+    else if (i16Sum < -QUAD_BACKLOG_MAX)
+    {
+        u16Clipped += (uint16_t)(-QUAD_BACKLOG_MAX - i16Sum);
+        i16Sum = -QUAD_BACKLOG_MAX;
+    }
+    *pu16ClippedP += u16Clipped;
+    return i16Sum;
+}
+
+//=============================================================================
+// Disables the quadrature interrupt and returns its previous state. TMR2IE is
+// read and cleared with all interrupts held off, otherwise the interrupt could
+// disable itself in between and the stale state would be written back.
+//=============================================================================
+static uint8_t DisableQuadInterrupt(void)
+{
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    uint8_t u8QuadEnabled = PIE1bits.TMR2IE;
+    PIE1bits.TMR2IE = 0;
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    return u8QuadEnabled;
+}
+
+//=============================================================================
+void QUAD_add_motion(int16_t i16DeltaXP, int16_t i16DeltaYP)
+{
+    if ((0 == i16DeltaXP) && (0 == i16DeltaYP))
+    {
+        return; // keep the current line
+    }
+    uint16_t u16Clipped = 0;
+    // don't let the interrupt modify the counts in the meantime
+    if (0 == DisableQuadInterrupt())
+    {
+        s_bLatencyResync = true;
+    }
+    s_i16PendingX = AddClamped(s_i16PendingX, i16DeltaXP, &u16Clipped);
+    s_i16PendingY = AddClamped(s_i16PendingY, i16DeltaYP, &u16Clipped);
+    s_bNewLine = true;
+    if ((0 != s_i16PendingX) || (0 != s_i16PendingY))
+    {
+        PIE1bits.TMR2IE = 1;
+    }
+    if (0 != u16Clipped)
+    {
+        (void)STATS_add(STATS_BACKLOG_CLIPPED, u16Clipped);
+    }
+}
+
+//=============================================================================
+bool QUAD_is_idle(void)
+{
+    // The interrupt disables itself when all the counts have been sent
+    return (0 == PIE1bits.TMR2IE);
+}
+
+//=============================================================================
+uint16_t QUAD_backlog(void)
+{
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    int16_t i16PendingX = s_i16PendingX;
+    int16_t i16PendingY = s_i16PendingY;
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    uint16_t u16AbsX = (i16PendingX < 0) ? -i16PendingX : i16PendingX;
+    uint16_t u16AbsY = (i16PendingY < 0) ? -i16PendingY : i16PendingY;
+    return u16AbsX + u16AbsY;
+}
+
+//=============================================================================
+void QUAD_set_profile(uint8_t u8ProfileP)
+{
+    uint8_t u8InterruptEnabled = DisableQuadInterrupt();
+    s_u8WindowSlots = aWindowSlots[u8ProfileP];
+    ClearWindow();
+    PIE1bits.TMR2IE = u8InterruptEnabled;
+}
+
+//=============================================================================
+void QUAD_set_slow_motion(bool bSlowMotionP)
+{
+    s_u8TicksPerStep = bSlowMotionP ? (QUAD_SLOW_MOTION_TICKS - 1) : 0;
+}
+
+//=============================================================================
+uint16_t QUAD_max_latency_us(void)
+{
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    uint16_t u16MaxLatency = s_u16MaxLatency;
+    s_u16MaxLatency = 0;
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    return u16MaxLatency;
+}
+
+//=============================================================================
+uint16_t QUAD_lost_ticks(void)
+{
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    uint16_t u16LostTicks = s_u16LostTicks;
+    s_u16LostTicks = 0;
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    return u16LostTicks;
+}
+
+//=============================================================================
+void QUAD_isr(void)
+{
+    // Timer2 restarts from 0 on the period match, so it tells the time since
+    // the latest match only. Timer1 runs freely at the same 1us rate: the
+    // interrupt serves the first match after the one served last, so the
+    // latency is measured from there, even if it's longer than the tick.
+    uint8_t u8SinceMatch = TMR2;
+    uint16_t u16NowUs = TMR1L; // reading TMR1L latches TMR1H
+    u16NowUs |= ((uint16_t)TMR1H << 8);
+    PIR1bits.TMR2IF = 0;
+    uint16_t u16MatchUs = u16NowUs - u8SinceMatch;
+    if (!s_bLatencyResync)
+    {
+        uint16_t u16Latency = u16NowUs - (s_u16LastMatchUs + QUAD_TICK_US);
+        if (u16Latency > s_u16MaxLatency)
+        {
+            s_u16MaxLatency = u16Latency;
+        }
+        // matches between the one served last and the latest one were lost
+        // (half a tick of tolerance for the two timers read one after another)
+        uint16_t u16Gap = u16MatchUs - s_u16LastMatchUs;
+        while (u16Gap > (QUAD_TICK_US + QUAD_TICK_US / 2))
+        {
+            s_u16LostTicks++;
+            u16Gap -= QUAD_TICK_US;
+        }
+    }
+    s_bLatencyResync = false;
+    s_u16LastMatchUs = u16MatchUs;
+    if (0 != s_u8TickCountdown)
+    {
+        s_u8TickCountdown--;
+        return;
+    }
+    AdvanceWindow();
+    if (s_u8WindowCounts >= QUAD_COUNTS_PER_WINDOW)
+    {
+        return; // frame budget spent, wait for the window to move
+    }
+    s_u8TickCountdown = s_u8TicksPerStep;
+
+    if (s_bNewLine)
+    {
+        StartLine();
+    }
+    StepLine();
+    SetQuadraturePhases(s_u8HorPhase, s_u8VerPhase);
+    // a step of the line is counted, which also covers the minor axis
+    s_au8SlotCounts[s_u8Slot]++;
+    s_u8WindowCounts++;
+
+    if ((0 == s_i16PendingX) && (0 == s_i16PendingY))
+    {
+        PIE1bits.TMR2IE = 0; // nothing more to send
+    }
+}
+
+//=============================================================================
@@ -0,0 +1,104 @@
+#ifndef __QUADRATURE_H__
+#define __QUADRATURE_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+//=============================================================================
+// Quadrature output engine.
+// The Timer2 interrupt owns H, HQ, V and VQ lines and sends one phase step
+// per tick from the pending X/Y counts, so the main loop only needs to add
+// new deltas and never waits for the pulses to be sent.
+//=============================================================================
+void QUAD_init(void);
+
+//=============================================================================
+// Adds mouse movement (in Amiga counts) to the pending X/Y counts
+//=============================================================================
+void QUAD_add_motion(int16_t i16DeltaXP, int16_t i16DeltaYP);
+
+//=============================================================================
+// Returns true if all pending counts have been sent to Amiga
+//=============================================================================
+bool QUAD_is_idle(void);
+
+//=============================================================================
+// Returns the number of counts waiting to be sent to Amiga (X plus Y)
+//=============================================================================
+uint16_t QUAD_backlog(void);
+
+//=============================================================================
+// Selects the frame budget profile: QUAD_PROFILE_PAL, QUAD_PROFILE_NTSC
+// or QUAD_PROFILE_FAST
+//=============================================================================
+void QUAD_set_profile(uint8_t u8ProfileP);
+
+//=============================================================================
+// Slows down the pulses to the speed used for gestures drawing
+//=============================================================================
+void QUAD_set_slow_motion(bool bSlowMotionP);
+
+//=============================================================================
+// Returns the longest delay between Timer2 period match and the interrupt
+// handler in microseconds since the last call. It's the jitter of the
+// quadrature edges (plus the constant context saving time). It's measured
+// with Timer1, so delays longer than the tick are seen too. The first
+// interrupt after the output has been idle is not measured.
+//
+// Expected from the code holding off interrupts (not measured on hardware):
+// a few us (EEPROM unlock, SROM stream byte read, Timer1 reads, copies of
+// the quadrature state), 46us with
+// the debug UART at 230400 baud. Slower cycle exact rates send only while
+// the quadrature is idle (see uart.c), Timer6 UART interrupt is low priority.
+//=============================================================================
+uint16_t QUAD_max_latency_us(void);
+
+//=============================================================================
+// Returns the number of quadrature ticks lost since the last call: a tick is
+// lost if the interrupt is held off for longer than QUAD_TICK_US.
+//=============================================================================
+uint16_t QUAD_lost_ticks(void);
+
+//=============================================================================
+// Timer2 interrupt handler. Called from the high priority interrupt only.
+//=============================================================================
+void QUAD_isr(void);
+
+//=============================================================================
+
+#endif // __QUADRATURE_H__
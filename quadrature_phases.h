@@ -0,0 +1,76 @@
+#ifndef __QUADRATURE_PHASES_H__
+#define __QUADRATURE_PHASES_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+
+//=============================================================================
+// Quadrature phase table of quadrature.c, in a header of its own so the host
+// check can include it.
+//=============================================================================
+
+//=============================================================================
+// Quadrature phases as the upper nibble of LATC
+// (V = LATC4, H = LATC5, HQ = LATC6, VQ = LATC7)
+//=============================================================================
+#define QUAD_PORT_MASK 0xF0
+
+#define X_PHASE_0 0x00 // H = LOW,  HQ = LOW
+#define X_PHASE_1 0x20 // H = HIGH, HQ = LOW
+#define X_PHASE_2 0x60 // H = HIGH, HQ = HIGH
+#define X_PHASE_3 0x40 // H = LOW,  HQ = HIGH
+
+#define Y_PHASE_0 0x00 // V = LOW,  VQ = LOW
+#define Y_PHASE_1 0x10 // V = HIGH, VQ = LOW
+#define Y_PHASE_2 0x90 // V = HIGH, VQ = HIGH
+#define Y_PHASE_3 0x80 // V = LOW,  VQ = HIGH
+
+// Indexed by (horizontal phase << 2) | vertical phase. Neighbouring phases
+// of one axis differ on one line only (Gray code), which is checked on
+// the host by tools/phase_table_check.cpp.
+static const uint8_t aPhaseTable[16] =
+{
+    X_PHASE_0 | Y_PHASE_0, X_PHASE_0 | Y_PHASE_1, X_PHASE_0 | Y_PHASE_2, X_PHASE_0 | Y_PHASE_3,
+    X_PHASE_1 | Y_PHASE_0, X_PHASE_1 | Y_PHASE_1, X_PHASE_1 | Y_PHASE_2, X_PHASE_1 | Y_PHASE_3,
+    X_PHASE_2 | Y_PHASE_0, X_PHASE_2 | Y_PHASE_1, X_PHASE_2 | Y_PHASE_2, X_PHASE_2 | Y_PHASE_3,
+    X_PHASE_3 | Y_PHASE_0, X_PHASE_3 | Y_PHASE_1, X_PHASE_3 | Y_PHASE_2, X_PHASE_3 | Y_PHASE_3,
+};
+
+//=============================================================================
+
+#endif // __QUADRATURE_PHASES_H__
@@ -0,0 +1,144 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include "scheduler.h"
+#include <stdbool.h>
+#include "timer.h"
+
+//=============================================================================
+// Types
+//=============================================================================
+typedef struct
+{
+    sched_task_t fnTask;
+    uint16_t u16PeriodMs;
+    uint16_t u16DeadlineMs; // relative to the release time
+    uint16_t u16ReleaseMs; // next release time
+} sched_slot_t;
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static sched_slot_t s_aSlots[SCHED_MAX_TASKS];
+static uint8_t s_u8TasksCount = 0;
+static bool s_bLastPassIdle = false;
+static uint16_t s_u16LastPassUs = 0; // TIMER_us() at the start of the last pass
+static uint32_t s_u32IdleUs = 0;
+static uint16_t s_u16DeadlineMisses = 0;
+
+//=============================================================================
+// Time comparison robust to the milliseconds counter wrap
+//=============================================================================
+#define TIME_REACHED(now, time) ((int16_t)((now) - (time)) >= 0)
+
+//=============================================================================
+void SCHED_add_task(sched_task_t fnTaskP, uint16_t u16PeriodMsP, uint16_t u16DeadlineMsP)
+{
+    if (s_u8TasksCount < SCHED_MAX_TASKS)
+    {
+        sched_slot_t *pSlot = &s_aSlots[s_u8TasksCount];
+        pSlot->fnTask = fnTaskP;
+        pSlot->u16PeriodMs = u16PeriodMsP;
+        pSlot->u16DeadlineMs = u16DeadlineMsP;
+        pSlot->u16ReleaseMs = TIMER_ms();
+        s_u8TasksCount++;
+    }
+}
+
+//=============================================================================
+void SCHED_run(void)
+{
+    uint16_t u16NowUs = TIMER_us();
+    if (s_bLastPassIdle)
+    {
+        s_u32IdleUs += (uint16_t)(u16NowUs - s_u16LastPassUs);
+    }
+    s_u16LastPassUs = u16NowUs;
+
+    // Find the released task with the earliest deadline
+    uint16_t u16NowMs = TIMER_ms();
+    sched_slot_t *pTask = 0;
+    uint16_t u16Deadline = 0;
+    for (uint8_t i = 0; i < s_u8TasksCount; i++)
+    {
+        sched_slot_t *pSlot = &s_aSlots[i];
+        if (TIME_REACHED(u16NowMs, pSlot->u16ReleaseMs))
+        {
+            uint16_t u16SlotDeadline = pSlot->u16ReleaseMs + pSlot->u16DeadlineMs;
+            if ((0 == pTask) || ((int16_t)(u16SlotDeadline - u16Deadline) < 0))
+            {
+                pTask = pSlot;
+                u16Deadline = u16SlotDeadline;
+            }
+        }
+    }
+
+    s_bLastPassIdle = (0 == pTask);
+    if (0 == pTask)
+    {
+        return;
+    }
+
+    pTask->u16ReleaseMs += pTask->u16PeriodMs;
+    if (TIME_REACHED(u16NowMs, pTask->u16ReleaseMs))
+    {
+        // The task is late by more than a period, skip the missed releases
+        pTask->u16ReleaseMs = u16NowMs + pTask->u16PeriodMs;
+    }
+    pTask->fnTask();
+    if (!TIME_REACHED(u16Deadline, TIMER_ms()))
+    {
+        s_u16DeadlineMisses++;
+    }
+}
+
+//=============================================================================
+uint32_t SCHED_idle_us(void)
+{
+    uint32_t u32IdleUs = s_u32IdleUs;
+    s_u32IdleUs = 0;
+    return u32IdleUs;
+}
+
+//=============================================================================
+uint16_t SCHED_deadline_misses(void)
+{
+    uint16_t u16DeadlineMisses = s_u16DeadlineMisses;
+    s_u16DeadlineMisses = 0;
+    return u16DeadlineMisses;
+}
+
+//=============================================================================
@@ -0,0 +1,78 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+
+//=============================================================================
+// Cooperative run-to-completion scheduler driven by the 1ms time base.
+// A task is released every period and should finish within its deadline
+// (both in milliseconds). From the released tasks the one with the earliest
+// deadline is run. Tasks must not busy-wait, a task that has nothing to do
+// returns at once.
+//=============================================================================
+#define SCHED_MAX_TASKS 9
+
+typedef void (*sched_task_t)(void);
+
+//=============================================================================
+// Adds a task released every u16PeriodMsP, first time at once.
+// u16DeadlineMsP is counted from the release, usually equal to the period.
+//=============================================================================
+void SCHED_add_task(sched_task_t fnTaskP, uint16_t u16PeriodMsP, uint16_t u16DeadlineMsP);
+
+//=============================================================================
+// Runs one released task or counts idle time if none is released.
+// To be called in the main loop.
+//=============================================================================
+void SCHED_run(void);
+
+//=============================================================================
+// Returns the time in microseconds spent with no task released since the
+// last call. Interrupts taken when idle are counted as idle time too.
+//=============================================================================
+uint32_t SCHED_idle_us(void);
+
+//=============================================================================
+// Returns the number of tasks which finished after their deadline since the
+// last call.
+//=============================================================================
+uint16_t SCHED_deadline_misses(void);
+
+//=============================================================================
+
+#endif // __SCHEDULER_H__
@@ -35,41 +35,182 @@
 
 #include "spi.h"
 #include <stdint.h>
+#include <pic18fregs.h>
 #include "amiga_mouse_config.h"
+#include "timer.h"
 
 //=============================================================================
+// [0] - byte being sent, [1] - byte being received.
+// An array is never split between RAM banks, so the assembly code needs one banksel.
+//=============================================================================
+static uint8_t s_au8Spi[2];
 
-static inline uint8_t SPI_bitBangData(uint8_t u8DataToSendP)
+//=============================================================================
+// Transfers one byte, MSB first. The bits are written in assembly, so the
+// timing doesn't depend on the code generated by the compiler.
+// Cycles per bit at 16MHz (1 cycle = 250ns):
+//  bcf SCLK             1  SCLK falling edge, the sensor outputs MISO bit
+//  bcf MOSI             1
+//  btfsc data, bit      1  MOSI may go low for a while, it doesn't matter
+//  bsf MOSI             1  while SCLK is low (skipped: btfsc takes 2)
+//  btfsc MISO           1  t_dly,MISO = 120ns passed 3 cycles ago
+//  bsf received, bit    1  (skipped: btfsc takes 2)
+//  bsf SCLK             1  t_setup,MOSI = 120ns passed 2 cycles ago
+// The next bit changes MOSI 2 cycles (500ns) after the rising edge of SCLK,
+// which is more than t_hold,MOSI = 200ns. SCLK is low for 6 cycles (1.5us)
+// and high for 1 cycle (250ns), the same as at the 2MHz max SCLK rate.
+// 7 cycles per bit, 56 cycles (14us) per byte plus banksel and the C code
+// passing the byte in and out. An interrupt may stretch a bit, SPI doesn't
+// mind. SCLK, MOSI and MISO must stay on RA1, RA0 and RA2.
+//=============================================================================
+uint8_t SPI_transfer(uint8_t u8DataP)
 {
-    uint8_t u8ReceivedData = 0;
-
-    for (uint8_t u8BitNum=8; u8BitNum != 0; u8BitNum--)
-    {
-        SCLK = LOW; // The ADNS-9800 sensor outputs MISO bits on falling edges of SCLK
-
-        // Send a bit to Slave; It takes more than max(t_setup,MOSI; t_dly,MISO)
-        MOSI = (u8DataToSendP & 0x80)? HIGH : LOW; // Take most significant bit from the byte to send
-        u8DataToSendP <<= 1;                       // and move all bits to the left
-        // t_setup,MOSI = 120ns - minimum time between setting bit on MOSI and rising edge of SCLK
-        // t_dly,MISO = 120ns - maximum time from falling edge of SCLK to show up new bit value on MISO
-        u8ReceivedData <<= 1; // To receive data from the Slave shift all bits of the output byte to the left,
-        u8ReceivedData |= (MISO == LOW)? 0x00 : 0x01; // receive one bit from MISO and store it as the least significant bit in the output byte
-        
-        SCLK = HIGH; // The ADNS-9800 Sensor reads MOSI on rising edges of SCLK.
-        Nop(); // t_hold,MOSI = 200ns
-    } 
-    return u8ReceivedData;
+    s_au8Spi[0] = u8DataP;
+    s_au8Spi[1] = 0;
+    __asm
+        banksel _s_au8Spi
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 7
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 7, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 7, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 6
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 6, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 6, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 5
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 5, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 5, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 4
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 4, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 4, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 3
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 3, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 3, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 2
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 2, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 2, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 1
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 1, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 1, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+        bcf     _LATAbits, 1, a         ; SCLK low, bit 0
+        bcf     _LATAbits, 0, a         ; MOSI low
+        btfsc   _s_au8Spi, 0, b
+        bsf     _LATAbits, 0, a         ; MOSI high
+        btfsc   _PORTAbits, 2, a        ; MISO
+        bsf     _s_au8Spi + 1, 0, b
+        bsf     _LATAbits, 1, a         ; SCLK high
+    __endasm;
+    //delay_us(120); // SPI time between write or write and read commands = 120us
+                     // SPI time between read and subsequent commands = 20us
+    return s_au8Spi[1];
 }
 
 //=============================================================================
 
-uint8_t SPI_transfer(uint8_t u8DataP)
+void SPI_write_flash_stream(uint16_t u16AddressP, uint16_t u16LengthP, uint8_t u8ByteTimeUsP)
 {
-    uint8_t u8ReceivedData;
-    u8ReceivedData = SPI_bitBangData(u8DataP);
-    //delay_us(120); // SPI time between write or write and read commands = 120us
-                     // SPI time between read and subsequent commands = 20us
-    return u8ReceivedData;
+    uint8_t u8AddressLow = (uint8_t)u16AddressP;
+    uint8_t u8AddressHigh = (uint8_t)(u16AddressP >> 8);
+
+    while (0 != u16LengthP)
+    {
+        u16LengthP--;
+        uint8_t u8ByteStart = (uint8_t)TIMER_us();
+
+        // Read the next byte from program memory with TBLRD*+, which also
+        // increments the table pointer. Interrupt code may use the table
+        // pointer too, so it is restored from RAM and read without interrupts
+        // of both priorities (GIEH masks all).
+        uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+        INTCONbits.GIEH = 0;
+        TBLPTRU = 0; // the whole program memory of PIC18F23K22/24K22 is below 64kB
+        TBLPTRH = u8AddressHigh;
+        TBLPTRL = u8AddressLow;
+        __asm
+            tblrd*+
+        __endasm;
+        s_au8Spi[0] = TABLAT;
+        u8AddressLow = TBLPTRL;
+        u8AddressHigh = TBLPTRH;
+        INTCONbits.GIEH = u8InterruptsEnabled;
+
+        // The bits of SPI_transfer() without MISO: 5 cycles (1.25us) per bit,
+        // 40 cycles (10us) per byte. MOSI is set 1 cycle (250ns) before
+        // the rising edge of SCLK and held for 2 cycles after it.
+        __asm
+            banksel _s_au8Spi
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 7
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 7, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 6
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 6, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 5
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 5, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 4
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 4, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 3
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 3, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 2
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 2, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 1
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 1, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+            bcf     _LATAbits, 1, a         ; SCLK low, bit 0
+            bcf     _LATAbits, 0, a         ; MOSI low
+            btfsc   _s_au8Spi, 0, b
+            bsf     _LATAbits, 0, a         ; MOSI high
+            bsf     _LATAbits, 1, a         ; SCLK high
+        __endasm;
+
+        // TIMER_us() counts whole microseconds, so the measured time may be
+        // up to 1us longer than the real one, 1us more is waited
+        while ((uint8_t)((uint8_t)TIMER_us() - u8ByteStart) <= u8ByteTimeUsP);
+    }
 }
 
 //=============================================================================
@@ -81,6 +222,7 @@ void SPI_init(void)
     MOSI_PORT_DIRECTION = OUTPUT;
     SCLK_PORT_DIRECTION = OUTPUT;
     NCS = HIGH;
+    (void)MISO; // MISO is read in the assembly code only, this makes SDCC declare PORTAbits
 }
 
 //=============================================================================
@@ -40,6 +40,14 @@
 //=============================================================================
 uint8_t SPI_transfer(uint8_t u8DataP);
 
+//=============================================================================
+// Sends "u16LengthP" bytes read from program memory at "u16AddressP".
+// Every byte takes more than "u8ByteTimeUsP" microseconds (up to 2us more,
+// interrupts may add to it): 10us of SPI bits, the program memory read
+// and the wait for TIMER_us().
+//=============================================================================
+void SPI_write_flash_stream(uint16_t u16AddressP, uint16_t u16LengthP, uint8_t u8ByteTimeUsP);
+
 //=============================================================================
 void SPI_init(void);
 
@@ -0,0 +1,118 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include "stats.h"
+#include "amiga_mouse_config.h"
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static uint16_t s_au16Counters[STATS_COUNTERS_COUNT];
+static uint16_t s_au16LastLogMs[STATS_COUNTERS_COUNT]; // TIMER_ms() of the last logged fault
+static bool s_bChanged = false;
+static uint8_t s_u8ReportCounter = STATS_COUNTERS_COUNT; // counter being sent
+
+static const uint8_t aReportMessages[STATS_COUNTERS_COUNT] =
+{
+    MSG_STATS_LASER_FAULT,
+    MSG_STATS_LP_INVALID,
+    MSG_STATS_DELTA_SATURATED,
+    MSG_STATS_EEPROM_WRITE_FAILED,
+    MSG_STATS_SPI_READBACK_MISMATCH,
+    MSG_STATS_BACKLOG_CLIPPED,
+};
+
+//=============================================================================
+bool STATS_count(uint8_t u8CounterP)
+{
+    return STATS_add(u8CounterP, 1);
+}
+
+//=============================================================================
+bool STATS_add(uint8_t u8CounterP, uint16_t u16AmountP)
+{
+    s_bChanged = true;
+    uint16_t u16NowMs = TIMER_ms();
+    bool bFirst = (0 == s_au16Counters[u8CounterP]);
+    if (u16AmountP > (uint16_t)(0xffff - s_au16Counters[u8CounterP]))
+    {
+        s_au16Counters[u8CounterP] = 0xffff;
+    }
+    else
+    {
+        s_au16Counters[u8CounterP] += u16AmountP;
+    }
+    if (bFirst || ((uint16_t)(u16NowMs - s_au16LastLogMs[u8CounterP]) >= STATS_LOG_INTERVAL_MS))
+    {
+        s_au16LastLogMs[u8CounterP] = u16NowMs;
+        return true;
+    }
+    return false;
+}
+
+//=============================================================================
+bool STATS_changed(void)
+{
+    bool bChanged = s_bChanged;
+    s_bChanged = false;
+    return bChanged;
+}
+
+//=============================================================================
+void STATS_report_start(void)
+{
+    s_u8ReportCounter = 0;
+}
+
+//=============================================================================
+bool STATS_report(void)
+{
+    if (s_u8ReportCounter >= STATS_COUNTERS_COUNT)
+    {
+        return false;
+    }
+    if (UART_free_space() >= 32) // rather than drop the line
+    {
+        uint16_t u16Count = s_au16Counters[s_u8ReportCounter];
+        LOG2(aReportMessages[s_u8ReportCounter], u16Count >> 8, u16Count & 0xff);
+        s_u8ReportCounter++;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+//=============================================================================
+// Fault statistics.
+// Faults are counted rather than logged on every occurrence. STATS_count()
+// tells if the fault should be logged: the first one of its kind, then at
+// most one per STATS_LOG_INTERVAL_MS:
+//     if (STATS_count(STATS_EEPROM_WRITE_FAILED)) LOG0(MSG_CALIBRATION_NOT_STORED);
+// Every counter has its report message (MSG_STATS_...) in aReportMessages
+// of stats.c.
+//=============================================================================
+typedef enum
+{
+    STATS_LASER_FAULT,           // motion burst with FAULT bit set
+    STATS_LP_INVALID,            // motion burst with LP_VALID bit cleared
+    STATS_DELTA_SATURATED,       // motion deltas above the quadrature frame budget
+    STATS_EEPROM_WRITE_FAILED,
+    STATS_SPI_READBACK_MISMATCH, // ADNS register read back differs from the value written
+    STATS_BACKLOG_CLIPPED,       // counts clipped off the quadrature backlog (not events)
+    STATS_COUNTERS_COUNT
+} stats_counter_t;
+
+//=============================================================================
+// Counts the fault (saturated at 0xffff). Returns true if it should be logged.
+//=============================================================================
+bool STATS_count(uint8_t u8CounterP);
+
+//=============================================================================
+// Adds u16AmountP to the counter (saturated at 0xffff), like STATS_count()
+//=============================================================================
+bool STATS_add(uint8_t u8CounterP, uint16_t u16AmountP);
+
+//=============================================================================
+// Returns true if any counter has changed since the last call
+//=============================================================================
+bool STATS_changed(void);
+
+//=============================================================================
+// STATS_report_start() starts sending all the counters, STATS_report() sends
+// the next one. It returns false when all of them are sent.
+//=============================================================================
+void STATS_report_start(void);
+bool STATS_report(void);
+
+//=============================================================================
+
+#endif // __STATS_H__
@@ -0,0 +1,96 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include "telemetry.h"
+#include "timer.h"
+#include "uart.h"
+#include "quadrature.h"
+#include "log.h"
+
+#if TELEMETRY
+#define TELEMETRY_ARGS 14
+// the text line (37 characters) or SLIP frame with all the bytes escaped (34)
+#define TELEMETRY_SPACE_MAX 37
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static uint8_t s_u8Decimation = 1; // every n-th sample is sent
+static uint8_t s_u8Skipped = 0; // samples skipped since the last one sent
+
+//=============================================================================
+void TELEMETRY_sample(const motion_burst_t *pMotionBurstP)
+{
+    s_u8Skipped++;
+    if (s_u8Skipped < s_u8Decimation)
+    {
+        return;
+    }
+    s_u8Skipped = 0;
+    uint8_t u8FreeSpace = UART_free_space();
+    if (u8FreeSpace < TELEMETRY_SPACE_MAX)
+    {
+        // the link is saturated, send fewer samples
+        if (s_u8Decimation < TELEMETRY_DECIMATION_MAX)
+        {
+            s_u8Decimation <<= 1;
+        }
+        return;
+    }
+    if ((u8FreeSpace > (UART_TX_BUFFER_SIZE / 2)) && (s_u8Decimation > 1))
+    {
+        s_u8Decimation >>= 1;
+    }
+    uint16_t u16Backlog = QUAD_backlog();
+    uint32_t u32Time = TIMER_us32();
+    g_au8LogArgs[0] = (uint8_t)(pMotionBurstP->i16DeltaX >> 8);
+    g_au8LogArgs[1] = (uint8_t)pMotionBurstP->i16DeltaX;
+    g_au8LogArgs[2] = (uint8_t)(pMotionBurstP->i16DeltaY >> 8);
+    g_au8LogArgs[3] = (uint8_t)pMotionBurstP->i16DeltaY;
+    g_au8LogArgs[4] = pMotionBurstP->u8Squal;
+    g_au8LogArgs[5] = (uint8_t)(pMotionBurstP->u16Shutter >> 8);
+    g_au8LogArgs[6] = (uint8_t)pMotionBurstP->u16Shutter;
+    g_au8LogArgs[7] = (uint8_t)(u16Backlog >> 8);
+    g_au8LogArgs[8] = (uint8_t)u16Backlog;
+    g_au8LogArgs[9] = (uint8_t)(u32Time >> 24);
+    g_au8LogArgs[10] = (uint8_t)(u32Time >> 16);
+    g_au8LogArgs[11] = (uint8_t)(u32Time >> 8);
+    g_au8LogArgs[12] = (uint8_t)u32Time;
+    g_au8LogArgs[13] = s_u8Decimation;
+    LOG_write(MSG_TELEMETRY32, TELEMETRY_ARGS);
+}
+#endif // TELEMETRY
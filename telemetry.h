@@ -0,0 +1,66 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include "amiga_mouse_config.h"
+#include "adns9800.h"
+
+//=============================================================================
+// Motion telemetry for filter and sensor tuning, built with TELEMETRY 1.
+// Each motion sample is sent as MSG_TELEMETRY32 with 14 argument bytes
+// (16 and 32-bit values big endian):
+//     delta X, delta Y, SQUAL, shutter, quadrature backlog,
+//     TIMER_us32() (wraps after 71 minutes), decimation
+// Samples are sent only when the sensor reports motion, so the timestamp is
+// wide enough to span the idle gaps between them.
+// With LOG_TOKENIZED it is a SLIP frame with CRC-8, tools/telemetry_capture
+// writes the samples to CSV. A sample is dropped rather than waited for if
+// the UART buffer is full. Then only every 2nd, 4th... sample is sent until
+// the buffer empties again.
+// Main loop only.
+//=============================================================================
+#if TELEMETRY
+void TELEMETRY_sample(const motion_burst_t *pMotionBurstP);
+#else
+#define TELEMETRY_sample(pMotionBurstP)
+#endif
+
+//=============================================================================
+
+#endif // __TELEMETRY_H__
@@ -0,0 +1,126 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include "timer.h"
+#include <pic18fregs.h>
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static volatile uint16_t s_u16Milliseconds = 0;
+static volatile uint16_t s_u16Timer1Overflows = 0; // upper word of TIMER_us32()
+
+//=============================================================================
+void TIMER_init(void)
+{
+    // Timer4 clock = Fosc/4 = 4MHz, prescaler 1:16 -> 1 timer count = 4us
+    T4CON = 0x02; // postscaler 1:1, prescaler 1:16, timer off
+    PR4 = 250 - 1; // 250 * 4us = 1ms
+    TMR4 = 0;
+    PIR5bits.TMR4IF = 0;
+    IPR5bits.TMR4IP = 0; // low priority
+    PIE5bits.TMR4IE = 1;
+    T4CONbits.TMR4ON = 1;
+
+    // Timer1 clock = Fosc/4 = 4MHz, prescaler 1:4 -> 1 timer count = 1us
+    T1GCON = 0x00; // no gate control
+    T1CON = 0x23; // Fosc/4, prescaler 1:4, 16-bit read/write mode, timer on
+    PIR1bits.TMR1IF = 0;
+    IPR1bits.TMR1IP = 0; // low priority
+    PIE1bits.TMR1IE = 1; // overflows counted for TIMER_us32()
+}
+
+//=============================================================================
+uint8_t TIMER_ms8(void)
+{
+    return (uint8_t)s_u16Milliseconds;
+}
+
+//=============================================================================
+uint16_t TIMER_ms(void)
+{
+    uint8_t u8InterruptEnabled = PIE5bits.TMR4IE;
+    PIE5bits.TMR4IE = 0; // two bytes are read, don't let the interrupt change them in between
+    uint16_t u16Milliseconds = s_u16Milliseconds;
+    PIE5bits.TMR4IE = u8InterruptEnabled;
+    return u16Milliseconds;
+}
+
+//=============================================================================
+uint16_t TIMER_us(void)
+{
+    // Reading TMR1L latches TMR1H, so an interrupt reading Timer1 in between
+    // would break the value; interrupts of both priorities are held off for
+    // the two reads (the quadrature interrupt reads Timer1 too).
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    uint16_t u16Time = TMR1L;
+    u16Time |= ((uint16_t)TMR1H << 8);
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    return u16Time;
+}
+
+//=============================================================================
+uint32_t TIMER_us32(void)
+{
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0; // see TIMER_us()
+    uint16_t u16Low = TMR1L;
+    u16Low |= ((uint16_t)TMR1H << 8);
+    uint16_t u16High = s_u16Timer1Overflows;
+    if (PIR1bits.TMR1IF && (u16Low < 0x8000))
+    {
+        u16High++; // the timer has just overflowed, the interrupt is still pending
+    }
+    INTCONbits.GIEH = u8InterruptsEnabled;
+    return ((uint32_t)u16High << 16) | u16Low;
+}
+
+//=============================================================================
+void TIMER_timer1_isr(void)
+{
+    PIR1bits.TMR1IF = 0;
+    s_u16Timer1Overflows++;
+}
+
+//=============================================================================
+void TIMER_isr(void)
+{
+    PIR5bits.TMR4IF = 0;
+    s_u16Milliseconds++;
+}
+
+//=============================================================================
@@ -0,0 +1,83 @@
+#ifndef __TIMER_H__
+#define __TIMER_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+
+//=============================================================================
+// System time base.
+// Timer4 interrupt counts milliseconds since the start,
+// Timer1 runs freely and counts microseconds.
+//=============================================================================
+void TIMER_init(void);
+
+//=============================================================================
+// Returns the lowest byte of the milliseconds counter (wraps every 256ms).
+// Reading a single byte is atomic, so it can be called from an interrupt.
+//=============================================================================
+uint8_t TIMER_ms8(void);
+
+//=============================================================================
+// Returns the milliseconds counter (wraps every 65.5s).
+//=============================================================================
+uint16_t TIMER_ms(void);
+
+//=============================================================================
+// Returns free running Timer1 value in microseconds (wraps every 65.5ms).
+// Useful for measuring short time intervals without an interrupt.
+//=============================================================================
+uint16_t TIMER_us(void);
+
+//=============================================================================
+// Returns microseconds since TIMER_init() (wraps after 71 minutes).
+// Timer1 overflows are counted by its interrupt.
+//=============================================================================
+uint32_t TIMER_us32(void);
+
+//=============================================================================
+// Timer1 overflow interrupt handler. Called from the low priority interrupt only.
+//=============================================================================
+void TIMER_timer1_isr(void);
+
+//=============================================================================
+// Timer4 interrupt handler. Called from the low priority interrupt only.
+//=============================================================================
+void TIMER_isr(void);
+
+//=============================================================================
+
+#endif // __TIMER_H__
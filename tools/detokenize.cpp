@@ -0,0 +1,150 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: C++11 compiler (host side tool)
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Host tool rebuilding the log texts sent by the firmware built with
+// LOG_TOKENIZED (see log.h). The messages are taken from log_messages.def
+// at build time, so the tool must be rebuilt when the list changes.
+//
+// Build: make -C tools (or g++ -o detokenize detokenize.cpp)
+// Usage: detokenize [capture_file]
+//        with no file the UART data is read from the standard input
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "slip.h"
+
+//=============================================================================
+// Messages dictionary
+//=============================================================================
+struct LogMessage
+{
+    const char *szId;
+    const char *szText;
+};
+
+static const LogMessage aMessages[] =
+{
+#define LOG_MSG(id, text) { #id, text },
+#include "../log_messages.def"
+#undef LOG_MSG
+};
+static const size_t MESSAGES_COUNT = sizeof(aMessages) / sizeof(aMessages[0]);
+
+//=============================================================================
+static size_t CountArgs(const char *szText)
+{
+    size_t count = 0;
+    for (; *szText; szText++)
+    {
+        if ('%' == *szText) count++;
+    }
+    return count;
+}
+
+//=============================================================================
+// Prints the message from a frame: index, arguments.
+// Returns false if the message is unknown.
+//=============================================================================
+static bool PrintFrame(const std::vector<uint8_t> &frame)
+{
+    uint8_t u8Message = frame[0];
+    if (u8Message >= MESSAGES_COUNT)
+    {
+        fprintf(stderr, "Unknown message %u (firmware newer than log_messages.def?)\n", u8Message);
+        return false;
+    }
+    const char *szText = aMessages[u8Message].szText;
+    size_t argsCount = frame.size() - 1;
+    if (argsCount != CountArgs(szText))
+    {
+        fprintf(stderr, "%s: %u arguments expected, %u received\n", aMessages[u8Message].szId,
+            (unsigned)CountArgs(szText), (unsigned)argsCount);
+        return false;
+    }
+    std::string text;
+    size_t arg = 1;
+    for (; *szText; szText++)
+    {
+        if ('%' == *szText)
+        {
+            char aHex[3];
+            snprintf(aHex, sizeof(aHex), "%02X", frame[arg++]);
+            text += aHex;
+        }
+        else
+        {
+            text += *szText;
+        }
+    }
+    fputs(text.c_str(), stdout);
+    fflush(stdout);
+    return true;
+}
+
+//=============================================================================
+int main(int argc, char *argv[])
+{
+    FILE *pInput = stdin;
+    if (argc > 1)
+    {
+        pInput = fopen(argv[1], "rb");
+        if (!pInput)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else
+    {
+        freopen(NULL, "rb", stdin);
+    }
+#endif
+
+    unsigned errors = SlipReadFrames(pInput, PrintFrame);
+    if (pInput != stdin)
+    {
+        fclose(pInput);
+    }
+    if (errors)
+    {
+        fprintf(stderr, "%u broken frames\n", errors);
+    }
+    return errors ? 2 : 0;
+}
+
+//=============================================================================
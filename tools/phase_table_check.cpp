@@ -0,0 +1,123 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: C++11 compiler (host side tool)
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Host check of the quadrature phase table (quadrature_phases.h).
+// For every phase of both axes and every step of -1, 0 or +1 on each axis
+// exactly one line of a stepping axis and no line of a standing axis may
+// change, and four steps in one direction must go through four different
+// phases. Quadrature lines are Gray coded, Amiga counts a wrong step or
+// a step lost when two lines change at once.
+//
+// Build: make -C tools (or g++ -o phase_table_check phase_table_check.cpp)
+// Usage: phase_table_check (or make -C tools check), exit code 0 if passed
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <cstdio>
+#include "../quadrature_phases.h"
+
+//=============================================================================
+static const uint8_t X_LINES = X_PHASE_0 | X_PHASE_1 | X_PHASE_2 | X_PHASE_3;
+static const uint8_t Y_LINES = Y_PHASE_0 | Y_PHASE_1 | Y_PHASE_2 | Y_PHASE_3;
+
+//=============================================================================
+static unsigned CountLines(uint8_t u8Lines)
+{
+    unsigned count = 0;
+    for (; u8Lines; u8Lines &= (uint8_t)(u8Lines - 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+//=============================================================================
+static uint8_t Phases(unsigned horPhase, unsigned verPhase)
+{
+    return aPhaseTable[((horPhase & 0x03) << 2) | (verPhase & 0x03)];
+}
+
+//=============================================================================
+int main()
+{
+    unsigned errors = 0;
+    if ((X_LINES & Y_LINES) || ((X_LINES | Y_LINES) != QUAD_PORT_MASK) ||
+        (2 != CountLines(X_LINES)) || (2 != CountLines(Y_LINES)))
+    {
+        printf("X lines 0x%02X and Y lines 0x%02X must be two lines each, together 0x%02X\n",
+            X_LINES, Y_LINES, QUAD_PORT_MASK);
+        errors++;
+    }
+    for (unsigned horPhase = 0; horPhase < 4; horPhase++)
+    {
+        for (unsigned verPhase = 0; verPhase < 4; verPhase++)
+        {
+            uint8_t u8Phases = Phases(horPhase, verPhase);
+            if (u8Phases & ~QUAD_PORT_MASK)
+            {
+                printf("phase %u/%u: 0x%02X is outside of 0x%02X\n", horPhase, verPhase, u8Phases, QUAD_PORT_MASK);
+                errors++;
+            }
+            // the same steps as StepX() and StepY(): +1, or +3 for -1
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    uint8_t u8Changed = u8Phases ^ Phases(horPhase + 4 + dx, verPhase + 4 + dy);
+                    if ((CountLines(u8Changed & X_LINES) != (unsigned)(dx * dx)) ||
+                        (CountLines(u8Changed & Y_LINES) != (unsigned)(dy * dy)))
+                    {
+                        printf("phase %u/%u step %+d/%+d: lines 0x%02X changed\n", horPhase, verPhase, dx, dy, u8Changed);
+                        errors++;
+                    }
+                }
+            }
+        }
+    }
+    for (unsigned phase = 0; phase < 4; phase++)
+    {
+        for (unsigned other = phase + 1; other < 4; other++)
+        {
+            if ((Phases(phase, 0) == Phases(other, 0)) || (Phases(0, phase) == Phases(0, other)))
+            {
+                printf("phases %u and %u are the same\n", phase, other);
+                errors++;
+            }
+        }
+    }
+    printf("Phase table check: %s\n", errors ? "FAILED" : "passed");
+    return errors ? 1 : 0;
+}
+
+//=============================================================================
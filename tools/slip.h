@@ -0,0 +1,130 @@
+#ifndef __SLIP_H__
+#define __SLIP_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: C++11 compiler (host side tool)
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// SLIP frame reader shared by the host tools. The frames are sent by log.c
+// in the LOG_TOKENIZED build: END, message index, arguments, CRC-8, END.
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+//=============================================================================
+// SLIP framing (RFC 1055)
+//=============================================================================
+static const uint8_t SLIP_END = 0xC0;
+static const uint8_t SLIP_ESC = 0xDB;
+static const uint8_t SLIP_ESC_END = 0xDC;
+static const uint8_t SLIP_ESC_ESC = 0xDD;
+
+//=============================================================================
+// CRC-8, polynomial 0x07, initial value 0 - the same as in log.c
+//=============================================================================
+static inline uint8_t Crc8(uint8_t u8Crc, uint8_t u8Data)
+{
+    u8Crc ^= u8Data;
+    for (int i = 0; i < 8; i++)
+    {
+        u8Crc = (u8Crc & 0x80) ? (uint8_t)((u8Crc << 1) ^ 0x07) : (uint8_t)(u8Crc << 1);
+    }
+    return u8Crc;
+}
+
+//=============================================================================
+// Reads the frames until the end of the input and passes each one with
+// a valid CRC to takeFrame(frame), the frame being the message index and
+// the arguments. takeFrame returns false if it can't use the frame.
+// Data before the first END is a part of a frame started before the capture
+// and is skipped. Returns the number of broken frames.
+//=============================================================================
+template <typename TakeFrame>
+unsigned SlipReadFrames(FILE *pInput, TakeFrame takeFrame)
+{
+    std::vector<uint8_t> frame;
+    bool bEscape = false;
+    bool bSynchronized = false;
+    unsigned errors = 0;
+    int c;
+    while (EOF != (c = fgetc(pInput)))
+    {
+        uint8_t u8Data = (uint8_t)c;
+        if (SLIP_END == u8Data)
+        {
+            if (bSynchronized && !frame.empty())
+            {
+                uint8_t u8Crc = 0;
+                for (size_t i = 0; i + 1 < frame.size(); i++)
+                {
+                    u8Crc = Crc8(u8Crc, frame[i]);
+                }
+                if ((frame.size() < 2) || (u8Crc != frame.back()))
+                {
+                    fprintf(stderr, "CRC error, frame dropped\n");
+                    errors++;
+                }
+                else
+                {
+                    frame.pop_back(); // CRC
+                    if (!takeFrame(frame))
+                    {
+                        errors++;
+                    }
+                }
+            }
+            bSynchronized = true;
+            frame.clear();
+            bEscape = false;
+        }
+        else if (SLIP_ESC == u8Data)
+        {
+            bEscape = true;
+        }
+        else
+        {
+            if (bEscape)
+            {
+                u8Data = (SLIP_ESC_END == u8Data) ? SLIP_END : (SLIP_ESC_ESC == u8Data) ? SLIP_ESC : u8Data;
+                bEscape = false;
+            }
+            frame.push_back(u8Data);
+        }
+    }
+    return errors;
+}
+
+//=============================================================================
+
+#endif // __SLIP_H__
@@ -0,0 +1,188 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: C++11 compiler (host side tool)
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Host tool writing the motion telemetry (see telemetry.h) to a CSV file.
+// The input is a capture of the firmware built with TELEMETRY and
+// LOG_TOKENIZED, other log messages are skipped. The message indexes are
+// taken from log_messages.def at build time, so the tool must be rebuilt
+// when the list changes.
+//
+// Build: make -C tools (or g++ -o telemetry_capture telemetry_capture.cpp)
+// Usage: telemetry_capture output.csv [capture_file]
+//        with no capture file the UART data is read from the standard input,
+//        so the samples are written as they come
+// The time column is in milliseconds (microsecond resolution) since the first
+// sample, unwrapped from the timestamps of the firmware (see TakeFrame()).
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "slip.h"
+
+//=============================================================================
+// Message indexes, the same as log_message_t in log.h
+//=============================================================================
+enum LogMessage
+{
+#define LOG_MSG(id, text) id,
+#include "../log_messages.def"
+#undef LOG_MSG
+};
+
+static const size_t TELEMETRY_ARGS = 12; // MSG_TELEMETRY of the former firmware, TIMER_ms()
+static const size_t TELEMETRY32_ARGS = 14; // MSG_TELEMETRY32, TIMER_us32()
+
+//=============================================================================
+struct Capture
+{
+    FILE *pOutput;
+    unsigned samples = 0;
+    bool bFirst = true;
+    uint8_t u8LastMessage = 0; // timestamps of different messages can't be compared
+    uint32_t u32LastTime = 0; // TIMER_us32() or TIMER_ms() of the previous sample
+    uint64_t time = 0; // unwrapped microseconds since the first sample
+};
+
+//=============================================================================
+static inline uint16_t Get16(const uint8_t *pData)
+{
+    return (uint16_t)((pData[0] << 8) | pData[1]);
+}
+
+//=============================================================================
+static inline uint32_t Get32(const uint8_t *pData)
+{
+    return ((uint32_t)Get16(pData) << 16) | Get16(&pData[2]);
+}
+
+//=============================================================================
+// Frame: message index, arguments. Other messages are skipped.
+// MSG_TELEMETRY32 has a 32-bit timestamp in microseconds, which wraps after
+// 71 minutes. MSG_TELEMETRY of captures from the former firmware has a 16-bit
+// one in milliseconds, then an idle gap longer than 65.5s is taken as
+// a shorter one.
+//=============================================================================
+static void TakeFrame(Capture &capture, const std::vector<uint8_t> &frame)
+{
+    const uint8_t *pArgs = &frame[1];
+    uint64_t elapsed; // since the previous sample in microseconds
+    uint8_t u8Decimation;
+    if ((MSG_TELEMETRY32 == frame[0]) && (frame.size() == TELEMETRY32_ARGS + 1))
+    {
+        uint32_t u32Time = Get32(&pArgs[9]);
+        elapsed = (uint32_t)(u32Time - capture.u32LastTime);
+        capture.u32LastTime = u32Time;
+        u8Decimation = pArgs[13];
+    }
+    else if ((MSG_TELEMETRY == frame[0]) && (frame.size() == TELEMETRY_ARGS + 1))
+    {
+        uint16_t u16Time = Get16(&pArgs[9]);
+        elapsed = (uint64_t)(uint16_t)(u16Time - capture.u32LastTime) * 1000;
+        capture.u32LastTime = u16Time;
+        u8Decimation = pArgs[11];
+    }
+    else
+    {
+        return;
+    }
+    if (!capture.bFirst && (frame[0] == capture.u8LastMessage))
+    {
+        capture.time += elapsed;
+    }
+    capture.bFirst = false;
+    capture.u8LastMessage = frame[0];
+    fprintf(capture.pOutput, "%llu.%03u,%d,%d,%u,%u,%u,%u\n", (unsigned long long)(capture.time / 1000),
+        (unsigned)(capture.time % 1000), (int16_t)Get16(&pArgs[0]), (int16_t)Get16(&pArgs[2]), pArgs[4],
+        Get16(&pArgs[5]), Get16(&pArgs[7]), u8Decimation);
+    capture.samples++;
+}
+
+//=============================================================================
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s output.csv [capture_file]\n", argv[0]);
+        return 1;
+    }
+    FILE *pInput = stdin;
+    if (argc > 2)
+    {
+        pInput = fopen(argv[2], "rb");
+        if (!pInput)
+        {
+            perror(argv[2]);
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else
+    {
+        freopen(NULL, "rb", stdin);
+    }
+#endif
+    Capture capture;
+    capture.pOutput = fopen(argv[1], "w");
+    if (!capture.pOutput)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    fputs("time_ms,dx,dy,squal,shutter,backlog,decimation\n", capture.pOutput);
+
+    unsigned errors = SlipReadFrames(pInput, [&capture, pInput](const std::vector<uint8_t> &frame)
+    {
+        TakeFrame(capture, frame);
+        if (pInput == stdin)
+        {
+            fflush(capture.pOutput);
+        }
+        return true;
+    });
+    if (pInput != stdin)
+    {
+        fclose(pInput);
+    }
+    fclose(capture.pOutput);
+    fprintf(stderr, "%u samples written", capture.samples);
+    if (errors)
+    {
+        fprintf(stderr, ", %u broken frames", errors);
+    }
+    fputc('\n', stderr);
+    return errors ? 2 : 0;
+}
+
+//=============================================================================
@@ -0,0 +1,267 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: C++11 compiler (host side tool)
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+// Host tool printing the flight recorder dump (see trace.h) with record
+// types and ages. The input is a capture of the firmware built with
+// LOG_TOKENIZED, or with -t a text log. The message indexes are taken from
+// log_messages.def at build time, so the tool must be rebuilt when the list
+// changes.
+//
+// Build: make -C tools (or g++ -o trace_decode trace_decode.cpp)
+// Usage: trace_decode [-t] [capture_file]
+//        with no file the UART data is read from the standard input
+//=============================================================================
+// Includes
+//=============================================================================
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "slip.h"
+
+//=============================================================================
+// Message indexes, the same as log_message_t in log.h
+//=============================================================================
+enum LogMessage
+{
+#define LOG_MSG(id, text) id,
+#include "../log_messages.def"
+#undef LOG_MSG
+};
+
+//=============================================================================
+// Trace records, the same as in trace.h
+//=============================================================================
+static const unsigned TIME_MASK = 0x1fff; // 13-bit timestamp in ms
+
+static const char * const aTypeNames[8] =
+{
+    "MOTION", "JUMP_X", "JUMP_Y", "MOTION_FLAGS", "BUTTONS", "MODE", "FAULT", "TYPE_7"
+};
+
+static const char * const aFaultNames[] =
+{
+    "laser fault", "invalid LP", "motion above frame budget", "EEPROM write failed", "SPI readback mismatch"
+};
+
+struct TraceRecord
+{
+    uint8_t au8Data[4];
+};
+
+struct TraceDump
+{
+    bool bStarted = false;
+    unsigned count = 0; // records announced by the header
+    bool bFault = false;
+    unsigned now = 0; // timestamp of freezing the recorder (the fault or the dump request)
+    std::vector<TraceRecord> records;
+};
+
+//=============================================================================
+static void PrintRecord(const TraceRecord &record, unsigned age)
+{
+    const uint8_t *pData = record.au8Data;
+    unsigned type = pData[0] >> 5;
+    printf("  -%5ums %-12s ", age, aTypeNames[type]);
+    switch (type)
+    {
+    case 0: // TRACE_MOTION
+        printf("dx=%d dy=%d\n", (int8_t)pData[2], (int8_t)pData[3]);
+        break;
+    case 1: // TRACE_JUMP_X
+    case 2: // TRACE_JUMP_Y
+        printf("%d\n", (int16_t)((pData[2] << 8) | pData[3]));
+        break;
+    case 3: // TRACE_MOTION_FLAGS
+        printf("motion=0x%02X%s%s%s op_mode=%u squal=%u\n", pData[2],
+            (pData[2] & 0x80) ? " MOT" : "", (pData[2] & 0x40) ? " FAULT" : "",
+            (pData[2] & 0x20) ? " LP_VALID" : "", (pData[2] >> 1) & 0x03, pData[3]);
+        break;
+    case 4: // TRACE_BUTTONS
+        printf("LMB=%s RMB=%s\n", pData[2] ? "down" : "up", pData[3] ? "down" : "up");
+        break;
+    case 5: // TRACE_MODE
+        printf("calibration=%s gesture=%u\n", pData[2] ? "on" : "off", pData[3]);
+        break;
+    case 6: // TRACE_FAULT
+        printf("%s motion=0x%02X\n",
+            (pData[2] < sizeof(aFaultNames) / sizeof(aFaultNames[0])) ? aFaultNames[pData[2]] : "unknown",
+            pData[3]);
+        break;
+    default:
+        printf("%02X %02X\n", pData[2], pData[3]);
+        break;
+    }
+}
+
+//=============================================================================
+// Prints the records of a dump, the oldest first, with their age at the time
+// the recorder was frozen (by the fault or the dump request). The 13-bit timestamps wrap every 8.19s, so a gap longer than
+// that between two records makes the older ones look younger.
+//=============================================================================
+static void PrintDump(TraceDump &dump)
+{
+    if (!dump.bStarted)
+    {
+        return;
+    }
+    printf("Trace dump: %u records, %s\n", dump.count,
+        dump.bFault ? "frozen by a fault, ages before the fault" : "on request");
+    if (dump.records.size() != dump.count)
+    {
+        fprintf(stderr, "%u records expected, %u received\n", dump.count, (unsigned)dump.records.size());
+    }
+    std::vector<unsigned> ages(dump.records.size());
+    unsigned age = 0;
+    unsigned later = dump.now;
+    for (size_t i = dump.records.size(); i-- > 0;)
+    {
+        const uint8_t *pData = dump.records[i].au8Data;
+        unsigned time = ((pData[0] & 0x1f) << 8) | pData[1];
+        age += (later - time) & TIME_MASK;
+        ages[i] = age;
+        later = time;
+    }
+    for (size_t i = 0; i < dump.records.size(); i++)
+    {
+        PrintRecord(dump.records[i], ages[i]);
+    }
+    fflush(stdout);
+    dump = TraceDump();
+}
+
+//=============================================================================
+// Takes MSG_TRACE_DUMP and MSG_TRACE_RECORD (4 arguments each), other
+// messages are skipped.
+//=============================================================================
+static void TakeMessage(TraceDump &dump, unsigned message, const uint8_t *pArgs)
+{
+    if (MSG_TRACE_DUMP == message)
+    {
+        PrintDump(dump);
+        dump.bStarted = true;
+        dump.count = pArgs[0];
+        dump.bFault = (0 != pArgs[1]);
+        dump.now = ((pArgs[2] << 8) | pArgs[3]) & TIME_MASK;
+    }
+    else if ((MSG_TRACE_RECORD == message) && dump.bStarted)
+    {
+        TraceRecord record;
+        memcpy(record.au8Data, pArgs, sizeof(record.au8Data));
+        dump.records.push_back(record);
+        if (dump.records.size() == dump.count)
+        {
+            PrintDump(dump);
+        }
+    }
+}
+
+//=============================================================================
+static unsigned ReadBinary(FILE *pInput, TraceDump &dump)
+{
+    return SlipReadFrames(pInput, [&dump](const std::vector<uint8_t> &frame)
+    {
+        if (5 == frame.size()) // index and 4 arguments
+        {
+            TakeMessage(dump, frame[0], &frame[1]);
+        }
+        return true;
+    });
+}
+
+//=============================================================================
+// Text log lines as printed by log.c, e.g. "Trace record: 2A1F0102"
+//=============================================================================
+static unsigned ReadText(FILE *pInput, TraceDump &dump)
+{
+    char aLine[256];
+    while (fgets(aLine, sizeof(aLine), pInput))
+    {
+        unsigned records, fault, time, record;
+        if (3 == sscanf(aLine, "Trace dump: records=%2x fault=%2x time=%4x", &records, &fault, &time))
+        {
+            const uint8_t aArgs[4] = { (uint8_t)records, (uint8_t)fault, (uint8_t)(time >> 8), (uint8_t)time };
+            TakeMessage(dump, MSG_TRACE_DUMP, aArgs);
+        }
+        else if (1 == sscanf(aLine, "Trace record: %8x", &record))
+        {
+            const uint8_t aArgs[4] = { (uint8_t)(record >> 24), (uint8_t)(record >> 16), (uint8_t)(record >> 8), (uint8_t)record };
+            TakeMessage(dump, MSG_TRACE_RECORD, aArgs);
+        }
+    }
+    return 0;
+}
+
+//=============================================================================
+int main(int argc, char *argv[])
+{
+    bool bText = false;
+    int arg = 1;
+    if ((arg < argc) && (0 == strcmp(argv[arg], "-t")))
+    {
+        bText = true;
+        arg++;
+    }
+    FILE *pInput = stdin;
+    if (arg < argc)
+    {
+        pInput = fopen(argv[arg], bText ? "r" : "rb");
+        if (!pInput)
+        {
+            perror(argv[arg]);
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else if (!bText)
+    {
+        freopen(NULL, "rb", stdin);
+    }
+#endif
+
+    TraceDump dump;
+    unsigned errors = bText ? ReadText(pInput, dump) : ReadBinary(pInput, dump);
+    PrintDump(dump); // a dump cut short by the end of the capture
+    if (pInput != stdin)
+    {
+        fclose(pInput);
+    }
+    if (errors)
+    {
+        fprintf(stderr, "%u broken frames\n", errors);
+    }
+    return errors ? 2 : 0;
+}
+
+//=============================================================================
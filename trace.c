@@ -0,0 +1,134 @@
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include "trace.h"
+#include "amiga_mouse_config.h"
+#include "timer.h"
+#include "uart.h"
+#include "log.h"
+
+#define TRACE_RECORDS_MASK (TRACE_RECORDS - 1)
+#define TRACE_TIME_MASK 0x1fff // 13-bit timestamp
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static uint8_t s_aau8Records[TRACE_RECORDS][4];
+static uint8_t s_u8Next = 0; // index of the next record
+static uint8_t s_u8Count = 0; // number of records kept
+static bool s_bFrozen = false;
+static bool s_bFault = false; // frozen by a fault rather than by the dump
+static uint16_t s_u16FrozenTime = 0; // TIMER_ms() when the recorder was frozen
+static uint8_t s_u8DumpLeft = 0; // records left to send
+static bool s_bDumpHeader = false; // MSG_TRACE_DUMP waits to be sent
+
+//=============================================================================
+void TRACE_add(uint8_t u8TypeP, uint8_t u8DataAP, uint8_t u8DataBP)
+{
+    if (s_bFrozen)
+    {
+        return;
+    }
+    uint16_t u16Time = TIMER_ms() & TRACE_TIME_MASK;
+    uint8_t *pRecord = s_aau8Records[s_u8Next];
+    pRecord[0] = (uint8_t)(u8TypeP << 5) | (uint8_t)(u16Time >> 8);
+    pRecord[1] = (uint8_t)u16Time;
+    pRecord[2] = u8DataAP;
+    pRecord[3] = u8DataBP;
+    s_u8Next = (s_u8Next + 1) & TRACE_RECORDS_MASK;
+    if (s_u8Count < TRACE_RECORDS)
+    {
+        s_u8Count++;
+    }
+}
+
+//=============================================================================
+static void Freeze(void)
+{
+    if (!s_bFrozen)
+    {
+        s_bFrozen = true;
+        s_u16FrozenTime = TIMER_ms() & TRACE_TIME_MASK;
+    }
+}
+
+//=============================================================================
+void TRACE_freeze(void)
+{
+    Freeze();
+    s_bFault = true;
+}
+
+//=============================================================================
+void TRACE_dump_start(void)
+{
+    Freeze(); // the records mustn't move while they are sent
+    s_bDumpHeader = true;
+    s_u8DumpLeft = s_u8Count;
+}
+
+//=============================================================================
+bool TRACE_dump(void)
+{
+    if (!s_bDumpHeader && (0 == s_u8DumpLeft))
+    {
+        return false;
+    }
+    if (UART_free_space() < 32)
+    {
+        return true; // rather than drop the line
+    }
+    if (s_bDumpHeader)
+    {
+        // the time of freezing lets the decoder tell the age of the records
+        // at the fault, the dump may be sent much later
+        LOG4(MSG_TRACE_DUMP, s_u8Count, s_bFault, s_u16FrozenTime >> 8, s_u16FrozenTime & 0xff);
+        s_bDumpHeader = false;
+    }
+    else
+    {
+        uint8_t *pRecord = s_aau8Records[(s_u8Next - s_u8DumpLeft) & TRACE_RECORDS_MASK];
+        LOG4(MSG_TRACE_RECORD, pRecord[0], pRecord[1], pRecord[2], pRecord[3]);
+        s_u8DumpLeft--;
+    }
+    if (0 == s_u8DumpLeft)
+    {
+        s_bFrozen = false;
+        s_bFault = false;
+    }
+    return true;
+}
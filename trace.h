@@ -0,0 +1,87 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+//=============================================================================
+//
+// MIT License
+// 
+// Copyright (c) 2021 Grzegorz Pietrusiak
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// 
+// Project name: Amiga Laser Mouse ADNS-9800
+// Project description: based on PIC18f23k22 microcontroller and ADNS-9800 Laser Gaming Sensor
+// PCB for the project: https://www.pcbway.com/project/shareproject/Amiga_Laser_Mouse.html
+// Toolchain: SDCC 3.9.0-rc1
+// 	gputils-1.5.0-1
+//
+// Author: Grzegorz Pietrusiak
+// Email: gpsspam2@gmail.com
+// 
+//=============================================================================
+//=============================================================================
+// Includes
+//=============================================================================
+#include <stdint.h>
+#include <stdbool.h>
+
+//=============================================================================
+// Flight recorder.
+// The last TRACE_RECORDS events are kept in RAM as 4 byte records:
+//     byte 0: type (bits 7..5), TIMER_ms() bits 12..8 (bits 4..0)
+//     byte 1: TIMER_ms() bits 7..0 (wraps every 8.19s)
+//     byte 2, 3: payload A, B as listed below
+// The recorder is frozen on a fault, so the events that led to it are kept
+// until they are sent. The dump is MSG_TRACE_DUMP (with the time of freezing,
+// so the ages are counted back from the fault) followed by one
+// MSG_TRACE_RECORD per record, the oldest first. tools/trace_decode prints
+// them from a LOG_TOKENIZED capture (or from a text log with -t).
+// Main loop only.
+//=============================================================================
+typedef enum
+{
+    TRACE_MOTION,       // A, B - delta X, Y (int8_t), larger ones are TRACE_JUMP_X/Y
+    TRACE_JUMP_X,       // A, B - delta X (int16_t, big endian) beyond the frame budget
+    TRACE_JUMP_Y,       // A, B - delta Y (int16_t, big endian) beyond the frame budget
+    TRACE_MOTION_FLAGS, // A - Motion register, B - SQUAL; when the Motion flags change
+    TRACE_BUTTONS,      // A - LMB pressed, B - RMB pressed
+    TRACE_MODE,         // A - Calibration Mode, B - gesture mode
+    TRACE_FAULT,        // A - STATS_... counter, B - Motion register
+    TRACE_TYPES_COUNT
+} trace_type_t;
+
+//=============================================================================
+// Adds a record, unless the recorder is frozen
+//=============================================================================
+void TRACE_add(uint8_t u8TypeP, uint8_t u8DataAP, uint8_t u8DataBP);
+
+//=============================================================================
+// Stops recording until the records are sent
+//=============================================================================
+void TRACE_freeze(void);
+
+//=============================================================================
+// TRACE_dump_start() starts sending the records, TRACE_dump() sends the next
+// one. It returns false when all of them are sent, then recording goes on.
+//=============================================================================
+void TRACE_dump_start(void);
+bool TRACE_dump(void);
+
+//=============================================================================
+
+#endif // __TRACE_H__
@@ -35,32 +35,259 @@
 // Includes
 //=============================================================================
 #include "uart.h"
-#include <delay.h>
+#include <pic18fregs.h>
+#include "profile.h"
+#include "quadrature.h"
 
 //=============================================================================
-// Sends one byte (8-bit) of data over UART TX pin
-// - bitrate: 9600
-// - stopbits: 1
-// - parity: none
-// 
+// Characters wait in a ring buffer, so printing never waits for the line.
+// Up to 19200 baud Timer6 interrupt sends them on the TX pin one bit per
+// tick. Faster bits are shorter than the interrupt overhead, so then
+// UART_task() sends whole characters with cycle exact code.
 //=============================================================================
-void UART_putc(uint8_t u8CharP)
+#define UART_TX_BUFFER_MASK (UART_TX_BUFFER_SIZE - 1)
+#if (UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) || (UART_TX_BUFFER_SIZE > 256)
+#error "UART_TX_BUFFER_SIZE must be a power of 2 up to 256"
+#endif
+
+// Instruction cycles (Fosc/4) per bit, rounded
+#define UART_BIT_CYCLES ((FOSC_HZ / 4 + UART_BAUDRATE / 2) / UART_BAUDRATE)
+
+#if UART_CYCLE_EXACT
+#if (UART_BIT_CYCLES < 9)
+#error "UART_BAUDRATE too high for the cycle exact code"
+#endif
+// Delays filling the bit time after the instructions of the bit loop
+#define UART_DELAY_START (UART_BIT_CYCLES - 5)
+#define UART_DELAY_BIT (UART_BIT_CYCLES - 9)
+#define UART_DELAY_STOP (UART_BIT_CYCLES - 6)
+// Interrupts are held off for 10 bits and ~12 cycles of SendCharCycleExact(),
+// one character costs ~40 cycles more in UART_task(). Counted from the code:
+//     baud    masked   chars/task  chars/s (line max)
+//     57600   176us    2           2000 (5760)
+//     115200  91us     5           5000 (11520)
+//     230400  46us     9           9000 (23040)
+#define UART_MASKED_CYCLES (10 * UART_BIT_CYCLES + 12)
+#define UART_CHAR_CYCLES (10 * UART_BIT_CYCLES + 40)
+#define UART_CHARS_PER_TASK ((UART_TASK_BUDGET_US * (FOSC_HZ / 4000000)) / UART_CHAR_CYCLES)
+#if (UART_CHARS_PER_TASK < 1)
+#error "UART_TASK_BUDGET_US too short for one character"
+#endif
+// A character shorter than the quadrature tick delays a step by up to the
+// character time, a longer one would lose a step, so it's sent only when
+// the quadrature output is idle
+#define UART_CHAR_FITS_TICK (UART_MASKED_CYCLES < (QUAD_TICK_US * (FOSC_HZ / 4000000)))
+#else
+// Timer6 clock = Fosc/4, prescaler 1:4 -> 1 timer count = 4 cycles
+#define UART_TIMER_COUNTS ((UART_BIT_CYCLES + 2) / 4)
+#if (UART_TIMER_COUNTS > 256)
+#error "UART_BAUDRATE too low for Timer6"
+#endif
+#endif
+
+//=============================================================================
+// Module variables
+//=============================================================================
+static uint8_t s_au8TxBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8_t s_u8TxHead = 0; // written by UART_putc()
+static volatile uint8_t s_u8TxTail = 0; // written by the sending code
+static bool s_bBlocking = false; // messages wait for space instead of being dropped
+static uint16_t s_u16Dropped = 0; // messages dropped because the buffer was full
+#if UART_CYCLE_EXACT
+// [0] - bits of the character being sent, [1] - bits left, [2] - delay counter.
+// An array is never split between RAM banks, so the assembly code needs one banksel.
+static uint8_t s_au8Bang[3];
+#else
+static uint8_t s_u8TxByte = 0; // bits of the character being sent
+static uint8_t s_u8TxBitsLeft = 0; // data bits and stop bit left, 0 - line idle
+#endif
+
+#if UART_CYCLE_EXACT
+//=============================================================================
+// Sends one character: start bit, 8 data bits (LSB first), stop bit.
+// Every bit lasts exactly UART_BIT_CYCLES, so all interrupts are held off
+// for one character time (87us at 115200).
+// The line is written with one movwf at a fixed cycle of every bit
+// no matter the bit value. LATBbits is used as LATB is not declared in this file.
+//=============================================================================
+static void SendCharCycleExact(uint8_t u8CharP)
 {
-    // each bit should last for 104.1666us on the line
-    // send start bit
-    UART = LOW;
-    delay10tcy(39);Nop();Nop();Nop();Nop();Nop();Nop();Nop(); // 104.25us
-    
-    for (uint8_t u8BitNum = 0; u8BitNum<8; u8BitNum++)
+    s_au8Bang[0] = u8CharP;
+    uint8_t u8InterruptsEnabled = INTCONbits.GIEH;
+    INTCONbits.GIEH = 0;
+    __asm
+        banksel _s_au8Bang
+        movlw   8
+        movwf   _s_au8Bang + 1, b
+        movf    _LATBbits, w, a
+        andlw   0xFB
+        movwf   _LATBbits, a            ; start bit
+#if (UART_DELAY_START) >= 4
+        movlw   ((UART_DELAY_START) - 1) / 3
+        movwf   _s_au8Bang + 2, b
+        decfsz  _s_au8Bang + 2, f, b
+        bra     $-2
+#endif
+#if ((UART_DELAY_START) >= 4 ? ((UART_DELAY_START) - 1) % 3 : (UART_DELAY_START)) >= 1
+        nop
+#endif
+#if ((UART_DELAY_START) >= 4 ? ((UART_DELAY_START) - 1) % 3 : (UART_DELAY_START)) >= 2
+        nop
+#endif
+#if ((UART_DELAY_START) >= 4 ? ((UART_DELAY_START) - 1) % 3 : (UART_DELAY_START)) >= 3
+        nop
+#endif
+uart_bit_loop:
+        movf    _LATBbits, w, a
+        andlw   0xFB
+        btfsc   _s_au8Bang, 0, b        ; 2 cycles for both bit values
+        iorlw   0x04
+        movwf   _LATBbits, a            ; data bit
+        rrncf   _s_au8Bang, f, b
+#if (UART_DELAY_BIT) >= 4
+        movlw   ((UART_DELAY_BIT) - 1) / 3
+        movwf   _s_au8Bang + 2, b
+        decfsz  _s_au8Bang + 2, f, b
+        bra     $-2
+#endif
+#if ((UART_DELAY_BIT) >= 4 ? ((UART_DELAY_BIT) - 1) % 3 : (UART_DELAY_BIT)) >= 1
+        nop
+#endif
+#if ((UART_DELAY_BIT) >= 4 ? ((UART_DELAY_BIT) - 1) % 3 : (UART_DELAY_BIT)) >= 2
+        nop
+#endif
+#if ((UART_DELAY_BIT) >= 4 ? ((UART_DELAY_BIT) - 1) % 3 : (UART_DELAY_BIT)) >= 3
+        nop
+#endif
+        decfsz  _s_au8Bang + 1, f, b
+        bra     uart_bit_loop
+        nop                             ; decfsz skip (2) + 3 nops = bra (2) + 3 cycles of the loop head
+        nop
+        nop
+        movf    _LATBbits, w, a
+        iorlw   0x04
+        movwf   _LATBbits, a            ; stop bit
+#if (UART_DELAY_STOP) >= 4
+        movlw   ((UART_DELAY_STOP) - 1) / 3
+        movwf   _s_au8Bang + 2, b
+        decfsz  _s_au8Bang + 2, f, b
+        bra     $-2
+#endif
+#if ((UART_DELAY_STOP) >= 4 ? ((UART_DELAY_STOP) - 1) % 3 : (UART_DELAY_STOP)) >= 1
+        nop
+#endif
+#if ((UART_DELAY_STOP) >= 4 ? ((UART_DELAY_STOP) - 1) % 3 : (UART_DELAY_STOP)) >= 2
+        nop
+#endif
+#if ((UART_DELAY_STOP) >= 4 ? ((UART_DELAY_STOP) - 1) % 3 : (UART_DELAY_STOP)) >= 3
+        nop
+#endif
+    __endasm;
+    INTCONbits.GIEH = u8InterruptsEnabled;
+}
+#endif
+
+//=============================================================================
+// Returns free space in the buffer, waits for it in blocking mode
+//=============================================================================
+static uint8_t GetFreeSpace(uint8_t u8NeededP)
+{
+    uint8_t u8Free = (uint8_t)(s_u8TxTail - s_u8TxHead - 1) & UART_TX_BUFFER_MASK;
+    while (s_bBlocking && (u8Free < u8NeededP))
     {
-        UART = (u8CharP & 0x01)? HIGH:LOW;
-        u8CharP >>= 1;
-        delay10tcy(39);Nop();Nop();Nop();Nop(); // 104us - 104.5us
+#if UART_CYCLE_EXACT
+        UART_task();
+#else
+        if (!INTCONbits.GIEH || !INTCONbits.GIEL)
+        {
+            break; // waiting makes sense only if the interrupt can empty the buffer
+        }
+#endif
+        u8Free = (uint8_t)(s_u8TxTail - s_u8TxHead - 1) & UART_TX_BUFFER_MASK;
     }
-    delay10tcy(1);Nop();Nop(); // 8th bit: 104us
-    // send stop bit
+    return u8Free;
+}
+
+//=============================================================================
+// Puts a character to the buffer, the free space must be checked before
+//=============================================================================
+static void PutToBuffer(uint8_t u8CharP)
+{
+    s_au8TxBuffer[s_u8TxHead] = u8CharP;
+    s_u8TxHead = (s_u8TxHead + 1) & UART_TX_BUFFER_MASK;
+#if !UART_CYCLE_EXACT
+    if (0 == PIE5bits.TMR6IE) // line idle, start sending
+    {
+        TMR6 = 0;
+        PIR5bits.TMR6IF = 0;
+        PIE5bits.TMR6IE = 1;
+    }
+#endif
+}
+
+//=============================================================================
+void UART_init(void)
+{
+    UART_PORT_DIRECTION = OUTPUT;
     UART = HIGH;
-    delay10tcy(36); // delay between two bytes sent 105.25us
+
+#if !UART_CYCLE_EXACT
+    T6CON = 0x01; // postscaler 1:1, prescaler 1:4, timer off
+    PR6 = UART_TIMER_COUNTS - 1;
+    TMR6 = 0;
+    PIR5bits.TMR6IF = 0;
+    IPR5bits.TMR6IP = 0; // low priority
+    PIE5bits.TMR6IE = 0; // the interrupt is enabled when there are characters to send
+    T6CONbits.TMR6ON = 1;
+#endif
+}
+
+//=============================================================================
+void UART_set_blocking(bool bBlockingP)
+{
+    s_bBlocking = bBlockingP;
+}
+
+//=============================================================================
+uint8_t UART_free_space(void)
+{
+    return GetFreeSpace(0);
+}
+
+//=============================================================================
+uint16_t UART_dropped_count(void)
+{
+    uint16_t u16Dropped = s_u16Dropped;
+    s_u16Dropped = 0;
+    return u16Dropped;
+}
+
+//=============================================================================
+bool UART_reserve(uint8_t u8LengthP)
+{
+    if (GetFreeSpace(u8LengthP) < u8LengthP)
+    {
+        s_u16Dropped++;
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================
+void UART_put_reserved(uint8_t u8CharP)
+{
+    PutToBuffer(u8CharP);
+}
+
+//=============================================================================
+void UART_putc(uint8_t u8CharP)
+{
+    if (0 == GetFreeSpace(1))
+    {
+        s_u16Dropped++;
+        return;
+    }
+    PutToBuffer(u8CharP);
 }
 
 //=============================================================================
@@ -68,10 +295,22 @@ void UART_putc(uint8_t u8CharP)
 //=============================================================================
 void UART_puts(const char *szStringP)
 {
-    while(*szStringP)
+    // a message is either sent whole or dropped
+    uint8_t u8Length = 0;
+    while (szStringP[u8Length] && (u8Length < UART_TX_BUFFER_MASK))
+    {
+        u8Length++;
+    }
+    if (GetFreeSpace(u8Length) < u8Length)
+    {
+        s_u16Dropped++;
+        return;
+    }
+    while (0 != u8Length)
     {
-        UART_putc((uint8_t)*szStringP);
+        PutToBuffer((uint8_t)*szStringP);
         szStringP++;
+        u8Length--;
     }
 }
 
@@ -79,8 +318,168 @@ void UART_puts(const char *szStringP)
 void UART_putb(uint8_t u8ByteP)
 {
     static const char aHex[] = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'};
-    UART_putc(aHex[u8ByteP>>4]);
-    UART_putc(aHex[u8ByteP&0x0f]);
+    if (GetFreeSpace(2) < 2)
+    {
+        s_u16Dropped++;
+        return;
+    }
+    PutToBuffer(aHex[u8ByteP>>4]);
+    PutToBuffer(aHex[u8ByteP&0x0f]);
+}
+
+#if UART_CYCLE_EXACT
+//=============================================================================
+void UART_task(void)
+{
+    PROF_BEGIN(u16ProfStart);
+    for (uint8_t u8Count = 0; u8Count < UART_CHARS_PER_TASK; u8Count++)
+    {
+        if (s_u8TxHead == s_u8TxTail)
+        {
+            break;
+        }
+#if !UART_CHAR_FITS_TICK
+        // the quadrature is started by the main loop only, so it stays idle
+        // until the character is sent
+        if (!QUAD_is_idle())
+        {
+            break;
+        }
+#endif
+        // interrupts are enabled between the characters, so a quadrature
+        // tick held off by one of them is served before the next one
+        SendCharCycleExact(s_au8TxBuffer[s_u8TxTail]);
+        s_u8TxTail = (s_u8TxTail + 1) & UART_TX_BUFFER_MASK;
+    }
+    PROF_END(PROF_UART_DRAIN, u16ProfStart);
+}
+#else
+#ifdef UART_LOOPBACK_TEST
+static void CheckReceived(void);
+#endif
+
+//=============================================================================
+// Sends one bit per Timer6 tick: start bit, 8 data bits (LSB first), stop bit
+//=============================================================================
+void UART_isr(void)
+{
+    PIR5bits.TMR6IF = 0;
+    if (0 == s_u8TxBitsLeft) // stop bit sent or line idle
+    {
+#ifdef UART_LOOPBACK_TEST
+        // EUSART2 holds 2 characters only (1.04ms at 19200), more than
+        // the 1ms task period, so the received ones are checked here after
+        // every character
+        CheckReceived();
+#endif
+        if (s_u8TxHead == s_u8TxTail)
+        {
+            PIE5bits.TMR6IE = 0; // nothing more to send
+            return;
+        }
+        s_u8TxByte = s_au8TxBuffer[s_u8TxTail];
+        s_u8TxTail = (s_u8TxTail + 1) & UART_TX_BUFFER_MASK;
+        UART = LOW; // start bit
+        s_u8TxBitsLeft = 9;
+        return;
+    }
+    s_u8TxBitsLeft--;
+    if (0 == s_u8TxBitsLeft)
+    {
+        UART = HIGH; // stop bit
+    }
+    else
+    {
+        UART = (s_u8TxByte & 0x01)? HIGH:LOW;
+        s_u8TxByte >>= 1;
+    }
+}
+#endif
+
+#ifdef UART_LOOPBACK_TEST
+//=============================================================================
+// Loopback test.
+// EUSART2 receives at the nominal baud rate, so bit time errors and bits
+// jitter show up as framing errors or wrong characters.
+//=============================================================================
+uint16_t g_u16UartTestReceived = 0;
+uint16_t g_u16UartTestErrors = 0;
+static uint8_t s_u8TestTxChar = 0;
+static uint8_t s_u8TestRxChar = 0; // next character expected
+static bool s_bTestSynchronized = false;
+
+//=============================================================================
+void UART_loopback_test_init(void)
+{
+    // send the start-up messages first, they are not a part of the test
+    s_bBlocking = true;
+    while (s_u8TxHead != s_u8TxTail)
+    {
+#if UART_CYCLE_EXACT
+        UART_task();
+#endif
+    }
+    s_bBlocking = false;
+
+    TRISBbits.RB7 = INPUT; // RX2
+    BAUDCON2 = 0x08; // BRG16 = 1
+    TXSTA2 = 0x04; // BRGH = 1, transmitter disabled
+    // baud rate = Fosc / (4 * (SPBRGH2:SPBRG2 + 1))
+    SPBRGH2 = (UART_BIT_CYCLES - 1) >> 8;
+    SPBRG2 = (UART_BIT_CYCLES - 1) & 0xff;
+    RCSTA2 = 0x90; // SPEN = 1, CREN = 1
+}
+
+//=============================================================================
+// Checks the characters received by EUSART2
+//=============================================================================
+static void CheckReceived(void)
+{
+    while (PIR3bits.RC2IF)
+    {
+        bool bFramingError = RCSTA2bits.FERR; // must be read before RCREG2
+        uint8_t u8Char = RCREG2;
+        // the first character may be cut by enabling the receiver
+        if (s_bTestSynchronized)
+        {
+            g_u16UartTestReceived++;
+            if (bFramingError || (u8Char != s_u8TestRxChar))
+            {
+                g_u16UartTestErrors++;
+            }
+        }
+        s_bTestSynchronized = true;
+        s_u8TestRxChar = u8Char + 1; // continue from the received one after an error
+    }
+    if (RCSTA2bits.OERR)
+    {
+        RCSTA2bits.CREN = 0; // clears the overrun
+        RCSTA2bits.CREN = 1;
+        g_u16UartTestErrors++;
+    }
+}
+
+//=============================================================================
+void UART_loopback_test(void)
+{
+#if UART_CYCLE_EXACT
+    // EUSART2 holds 2 characters only, so each one is checked right after
+    // it's sent (the receiver flags it in the middle of the stop bit)
+    for (uint8_t u8Count = 0; u8Count < UART_CHARS_PER_TASK; u8Count++)
+    {
+        SendCharCycleExact(s_u8TestTxChar);
+        s_u8TestTxChar++;
+        CheckReceived();
+    }
+#else
+    // the received characters are checked by UART_isr(), keep the buffer full
+    while (0 != ((uint8_t)(s_u8TxTail - s_u8TxHead - 1) & UART_TX_BUFFER_MASK))
+    {
+        PutToBuffer(s_u8TestTxChar);
+        s_u8TestTxChar++;
+    }
+#endif
 }
+#endif
 
 //=============================================================================
@@ -38,22 +38,47 @@
 //=============================================================================
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "amiga_mouse_config.h"
 
 //=============================================================================
-static inline void UART_init(void)
-{
-    // Initialize UART
-    UART_PORT_DIRECTION = OUTPUT;
-    UART = HIGH;
-}
+// Debug output, TX only, bit banged on UART pin by Timer6 interrupt or by
+// UART_task() above 19200 baud
+// - bitrate: UART_BAUDRATE
+// - stopbits: 1
+// - parity: none
+//=============================================================================
+#define UART_CYCLE_EXACT (UART_BAUDRATE > 19200)
+
+void UART_init(void);
+
+//=============================================================================
+// In blocking mode a message waits for space in the buffer rather than
+// being dropped. Used during the start-up, before the tasks run.
+//=============================================================================
+void UART_set_blocking(bool bBlockingP);
+
+//=============================================================================
+// Returns the number of characters that can be put to the buffer now.
+// A message that doesn't fit the buffer is dropped.
+//=============================================================================
+uint8_t UART_free_space(void);
+
+//=============================================================================
+// Returns the number of messages dropped since the last call
+//=============================================================================
+uint16_t UART_dropped_count(void);
+
+//=============================================================================
+// Reserves buffer space for a message of u8LengthP characters, which are then
+// put by UART_put_reserved(). Returns false and counts the message as dropped
+// if there is not enough space.
+//=============================================================================
+bool UART_reserve(uint8_t u8LengthP);
+void UART_put_reserved(uint8_t u8CharP);
 
 //=============================================================================
 // Sends one byte (8-bit) of data over UART TX pin
-// - bitrate: 9600
-// - stopbits: 1
-// - parity: none
-// 
 //=============================================================================
 void UART_putc(uint8_t u8CharP);
 
@@ -62,9 +87,38 @@ void UART_putc(uint8_t u8CharP);
 //=============================================================================
 void UART_puts(const char *szStringP);
 
+//=============================================================================
+// Sends a byte as 2 hex digits
 //=============================================================================
 void UART_putb(uint8_t u8ByteP);
 
+#if UART_CYCLE_EXACT
+//=============================================================================
+// Sends characters from the buffer for up to UART_TASK_BUDGET_US. To be run
+// as a scheduler task every 1ms. Below 230400 baud a character is longer
+// than the quadrature tick, then it's sent only while the quadrature is idle.
+//=============================================================================
+void UART_task(void);
+#else
+//=============================================================================
+// Timer6 interrupt handler. Called from the low priority interrupt only.
+//=============================================================================
+void UART_isr(void);
+#endif
+
+#ifdef UART_LOOPBACK_TEST
+//=============================================================================
+// Loopback test for the simulator (uart_test.bat). UART pin (RB2) must be
+// connected to EUSART2 RX (RB7). UART_loopback_test() is a scheduler task
+// sending all byte values in turn and checking the received ones.
+//=============================================================================
+extern uint16_t g_u16UartTestReceived;
+extern uint16_t g_u16UartTestErrors; // framing errors, overruns and wrong characters
+
+void UART_loopback_test_init(void);
+void UART_loopback_test(void);
+#endif
+
 //=============================================================================
 
 #endif // __UART_H__
@@ -0,0 +1,18 @@
+@echo off
+rem UART loopback test in gpsim at every supported baud rate.
+rem The firmware is built with UART_LOOPBACK_TEST: it sends all byte values
+rem from RB2 and checks them with EUSART2 receiver on RB7 (see uart.c).
+set PATH=C:\Program Files (x86)\gpsim\bin;%PATH%
+for %%B in (9600 19200 57600 115200 230400) do (
+    echo === %%B baud
+    make cleanall
+    make DEFS="-DUART_BAUDRATE=%%B -DUART_LOOPBACK_TEST" || goto error
+    echo USART.rxbaud = %%B> uart_test_baud.stc
+    "C:\Program Files (x86)\gpsim\bin\gpsim" -i --command=uart_test.commands
+)
+del uart_test_baud.stc
+pause
+exit /b 0
+:error
+pause
+exit /b 1